@@ -0,0 +1,301 @@
+// alloc_profiler.hpp - attribution of heap allocations to internal subsystems
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_ALLOC_PROFILER_H_
+#define UREACT_ALLOC_PROFILER_H_
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Allocation counters per subsystem
+struct alloc_stats
+{
+    enum : int
+    {
+        subsystems_count = static_cast<int>( detail::alloc_subsystem::count )
+    };
+
+    std::uint64_t count[subsystems_count] = {}; ///< Number of allocations
+    std::uint64_t bytes[subsystems_count] = {}; ///< Number of allocated bytes
+
+    std::uint64_t count_of( const detail::alloc_subsystem subsystem ) const
+    {
+        return count[static_cast<int>( subsystem )];
+    }
+
+    std::uint64_t bytes_of( const detail::alloc_subsystem subsystem ) const
+    {
+        return bytes[static_cast<int>( subsystem )];
+    }
+
+    /// Number of allocations in all subsystems except allocations made by user code
+    std::uint64_t internal_count() const
+    {
+        std::uint64_t result = 0;
+        for( int i = static_cast<int>( detail::alloc_subsystem::user ) + 1; i < subsystems_count;
+             ++i )
+        {
+            result += count[i];
+        }
+        return result;
+    }
+};
+
+inline const char* to_string( const detail::alloc_subsystem subsystem )
+{
+    switch( subsystem )
+    {
+        case detail::alloc_subsystem::user: return "user";
+        case detail::alloc_subsystem::node_creation: return "node_creation";
+        case detail::alloc_subsystem::successors: return "successors";
+        case detail::alloc_subsystem::scheduler_queue: return "scheduler_queue";
+        case detail::alloc_subsystem::observer_registration: return "observer_registration";
+        case detail::alloc_subsystem::value_copy: return "value_copy";
+        case detail::alloc_subsystem::count: break;
+    }
+    return "unknown";
+}
+
+namespace detail
+{
+
+struct alloc_counters
+{
+    std::atomic<std::uint64_t> count[alloc_stats::subsystems_count];
+    std::atomic<std::uint64_t> bytes[alloc_stats::subsystems_count];
+};
+
+inline alloc_counters& get_alloc_counters()
+{
+    // Zero-initialized before any dynamic initialization
+    static alloc_counters counters;
+    return counters;
+}
+
+/// Should be called by the global allocation function for every allocation
+inline void record_allocation( const std::size_t size )
+{
+    alloc_counters& counters = get_alloc_counters();
+    const auto i = static_cast<int>( current_alloc_subsystem() );
+    counters.count[i].fetch_add( 1, std::memory_order_relaxed );
+    counters.bytes[i].fetch_add( size, std::memory_order_relaxed );
+}
+
+/// Return allocations recorded since the program start
+inline alloc_stats recorded_allocations()
+{
+    alloc_counters& counters = get_alloc_counters();
+    alloc_stats result;
+    for( int i = 0; i < alloc_stats::subsystems_count; ++i )
+    {
+        result.count[i] = counters.count[i].load( std::memory_order_relaxed );
+        result.bytes[i] = counters.bytes[i].load( std::memory_order_relaxed );
+    }
+    return result;
+}
+
+inline void* counting_allocate( const std::size_t size ) noexcept
+{
+    record_allocation( size );
+    return std::malloc( size != 0 ? size : 1 );
+}
+
+} // namespace detail
+
+
+/*! @brief Reports heap allocations per subsystem made during propagation turns and between them
+ *
+ *  Allocations are counted by the global allocation functions defined with
+ *  UREACT_DEFINE_ALLOC_PROFILING_OPERATORS in one translation unit of the program.
+ *  They are attributed to subsystems only if UREACT_ENABLE_ALLOC_PROFILING is defined,
+ *  otherwise all of them are reported as user allocations.
+ *
+ *  Counters are global, so allocations of other threads made during a turn are included.
+ *  Setup work like node creation and observer registration is done between turns,
+ *  so it is reported by outside_turns().
+ */
+class alloc_profiler : private detail::scoped_turn_listener
+{
+public:
+    explicit alloc_profiler( context& ctx )
+        : scoped_turn_listener( ctx )
+        , m_outside_start( detail::recorded_allocations() )
+    {}
+
+    alloc_profiler( const alloc_profiler& ) = delete;
+    alloc_profiler& operator=( const alloc_profiler& ) = delete;
+    alloc_profiler( alloc_profiler&& ) noexcept = delete;
+    alloc_profiler& operator=( alloc_profiler&& ) noexcept = delete;
+
+    /// Allocations made during the last turn
+    const alloc_stats& last_turn() const
+    {
+        return m_last_turn;
+    }
+
+    /// Allocations made during all turns
+    const alloc_stats& total() const
+    {
+        return m_total;
+    }
+
+    /// Allocations made between turns since construction or the last reset()
+    alloc_stats outside_turns() const
+    {
+        alloc_stats result = m_outside;
+        if( !m_in_turn )
+        {
+            accumulate( result, m_outside_start, detail::recorded_allocations() );
+        }
+        return result;
+    }
+
+    /// Number of observed turns
+    std::uint64_t turns() const
+    {
+        return m_turns;
+    }
+
+    /// Number of observed turns with at least one internal allocation
+    std::uint64_t allocating_turns() const
+    {
+        return m_allocating_turns;
+    }
+
+    /// Return average counts and bytes per turn for every subsystem, one subsystem per line
+    std::string report_text() const
+    {
+        const double turns = m_turns != 0 ? static_cast<double>( m_turns ) : 1.0;
+
+        std::string result;
+        for( int i = 0; i < alloc_stats::subsystems_count; ++i )
+        {
+            result += to_string( static_cast<detail::alloc_subsystem>( i ) );
+            result += ": " + std::to_string( static_cast<double>( m_total.count[i] ) / turns )
+                    + " allocations, "
+                    + std::to_string( static_cast<double>( m_total.bytes[i] ) / turns )
+                    + " bytes per turn\n";
+        }
+
+        const alloc_stats outside = outside_turns();
+        for( int i = 0; i < alloc_stats::subsystems_count; ++i )
+        {
+            result += to_string( static_cast<detail::alloc_subsystem>( i ) );
+            result += ": " + std::to_string( outside.count[i] ) + " allocations, "
+                    + std::to_string( outside.bytes[i] ) + " bytes outside of turns\n";
+        }
+        return result;
+    }
+
+    /// Forget all collected statistics
+    void reset()
+    {
+        m_last_turn = alloc_stats{};
+        m_total = alloc_stats{};
+        m_outside = alloc_stats{};
+        m_outside_start = detail::recorded_allocations();
+        m_turns = 0;
+        m_allocating_turns = 0;
+    }
+
+private:
+    // Add allocations made between the two snapshots to the stats
+    static void accumulate( alloc_stats& stats, const alloc_stats& from, const alloc_stats& to )
+    {
+        for( int i = 0; i < alloc_stats::subsystems_count; ++i )
+        {
+            stats.count[i] += to.count[i] - from.count[i];
+            stats.bytes[i] += to.bytes[i] - from.bytes[i];
+        }
+    }
+
+    void on_turn_begin( detail::turn_id_t /*turn*/ ) override
+    {
+        m_turn_start = detail::recorded_allocations();
+        accumulate( m_outside, m_outside_start, m_turn_start );
+        m_in_turn = true;
+    }
+
+    void on_turn_end( detail::turn_id_t /*turn*/ ) override
+    {
+        const alloc_stats now = detail::recorded_allocations();
+        m_last_turn = alloc_stats{};
+        accumulate( m_last_turn, m_turn_start, now );
+        accumulate( m_total, m_turn_start, now );
+
+        m_outside_start = now;
+        m_in_turn = false;
+
+        ++m_turns;
+        if( m_last_turn.internal_count() != 0 )
+        {
+            ++m_allocating_turns;
+        }
+    }
+
+    alloc_stats m_turn_start;
+    alloc_stats m_last_turn;
+    alloc_stats m_total;
+
+    alloc_stats m_outside_start;
+    alloc_stats m_outside;
+    bool m_in_turn = false;
+
+    std::uint64_t m_turns = 0;
+    std::uint64_t m_allocating_turns = 0;
+};
+
+UREACT_END_NAMESPACE
+
+/// Define global allocation functions that record allocations for alloc_profiler.
+/// Should be used once per program at global namespace scope
+#define UREACT_DEFINE_ALLOC_PROFILING_OPERATORS                                                    \
+    void* operator new( std::size_t size )                                                         \
+    {                                                                                              \
+        if( void* p = ::ureact::detail::counting_allocate( size ) )                                \
+            return p;                                                                              \
+        throw std::bad_alloc();                                                                    \
+    }                                                                                              \
+    void* operator new[]( std::size_t size )                                                       \
+    {                                                                                              \
+        return operator new( size );                                                               \
+    }                                                                                              \
+    void* operator new( std::size_t size, const std::nothrow_t& ) noexcept                         \
+    {                                                                                              \
+        return ::ureact::detail::counting_allocate( size );                                        \
+    }                                                                                              \
+    void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept                       \
+    {                                                                                              \
+        return ::ureact::detail::counting_allocate( size );                                        \
+    }                                                                                              \
+    void operator delete( void* p ) noexcept                                                       \
+    {                                                                                              \
+        std::free( p );                                                                            \
+    }                                                                                              \
+    void operator delete[]( void* p ) noexcept                                                     \
+    {                                                                                              \
+        std::free( p );                                                                            \
+    }                                                                                              \
+    void operator delete( void* p, std::size_t ) noexcept                                          \
+    {                                                                                              \
+        std::free( p );                                                                            \
+    }                                                                                              \
+    void operator delete[]( void* p, std::size_t ) noexcept                                        \
+    {                                                                                              \
+        std::free( p );                                                                            \
+    }
+
+#endif // UREACT_ALLOC_PROFILER_H_
@@ -0,0 +1,216 @@
+// causality_tracker.hpp - attribution of node ticks and observer invocations to changed inputs
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_CAUSALITY_TRACKER_H_
+#define UREACT_CAUSALITY_TRACKER_H_
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/*! @brief Records which changed inputs reached every ticked node
+ *
+ *  Each changed input gets a set with itself. Sets are merged into successors on every pulse,
+ *  so when a node is ticked, its set contains all changed inputs that reached it during
+ *  the turn. Sets are stored as sorted vectors of compact input indices.
+ *
+ *  Sets of ticked nodes are kept for the last history_size turns. Besides that, number of
+ *  ticks of each node triggered by each input is aggregated over all turns. A node can be
+ *  ticked more than once in a turn, e.g. when an observer changes an input.
+ */
+class causality_tracker : private detail::scoped_turn_listener
+{
+public:
+    explicit causality_tracker( context& ctx, const size_t history_size = 1024 )
+        : scoped_turn_listener( ctx )
+        , m_history_size( history_size )
+    {}
+
+    causality_tracker( const causality_tracker& ) = delete;
+    causality_tracker& operator=( const causality_tracker& ) = delete;
+    causality_tracker( causality_tracker&& ) noexcept = delete;
+    causality_tracker& operator=( causality_tracker&& ) noexcept = delete;
+
+    /// Return ids of inputs that triggered the node in the given turn.
+    /// Empty result means that the node wasn't ticked or the turn is out of history
+    std::vector<detail::node_id_t> triggers( const detail::node_id_t node,
+        const detail::turn_id_t turn ) const
+    {
+        std::vector<detail::node_id_t> result;
+        for( const turn_entry& entry : m_history )
+        {
+            if( entry.turn != turn )
+            {
+                continue;
+            }
+            for( const auto& ticked : entry.ticked )
+            {
+                if( ticked.first == node )
+                {
+                    for( const input_index_t input : ticked.second )
+                    {
+                        result.push_back( m_inputs[input] );
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    /// Return pairs of input id and number of ticks of the node it triggered.
+    /// The most frequent inputs go first
+    std::vector<std::pair<detail::node_id_t, std::uint64_t>> trigger_counts(
+        const detail::node_id_t node ) const
+    {
+        std::vector<std::pair<detail::node_id_t, std::uint64_t>> result;
+
+        const auto it = m_counts.find( node );
+        if( it != m_counts.end() )
+        {
+            for( const auto& p : it->second )
+            {
+                result.emplace_back( m_inputs[p.first], p.second );
+            }
+        }
+
+        std::sort( result.begin(),
+            result.end(),
+            []( const std::pair<detail::node_id_t, std::uint64_t>& lhs,
+                const std::pair<detail::node_id_t, std::uint64_t>& rhs ) {
+                return lhs.second > rhs.second;
+            } );
+
+        return result;
+    }
+
+    /// Forget all collected history, counters and known inputs
+    void reset()
+    {
+        m_inputs.clear();
+        m_input_indices.clear();
+        m_history.clear();
+        m_counts.clear();
+        m_sets.clear();
+    }
+
+private:
+    using input_index_t = std::uint32_t;
+    using input_set_t = std::vector<input_index_t>;
+
+    struct turn_entry
+    {
+        detail::turn_id_t turn;
+        std::vector<std::pair<detail::node_id_t, input_set_t>> ticked;
+    };
+
+    input_index_t index_of( const detail::reactive_node& input )
+    {
+        const detail::node_id_t id = detail::get_node_id( input );
+        const auto result
+            = m_input_indices.emplace( id, static_cast<input_index_t>( m_inputs.size() ) );
+        if( result.second )
+        {
+            m_inputs.push_back( id );
+        }
+        return result.first->second;
+    }
+
+    void on_turn_begin( const detail::turn_id_t turn ) override
+    {
+        m_sets.clear();
+
+        if( m_history_size == 0 )
+        {
+            return;
+        }
+        if( m_history.size() == m_history_size )
+        {
+            m_history.pop_front();
+        }
+        m_history.push_back( turn_entry{ turn, {} } );
+    }
+
+    void on_input_applied( const detail::reactive_node& node ) override
+    {
+        input_set_t& set = m_sets[&node];
+        merge( set, input_set_t{ index_of( node ) } );
+        merge_into_successors( node, set );
+    }
+
+    void on_node_pulse( const detail::reactive_node& node ) override
+    {
+        const auto it = m_sets.find( &node );
+        if( it != m_sets.end() )
+        {
+            merge_into_successors( node, it->second );
+        }
+    }
+
+    void on_tick_end( const detail::reactive_node& node ) override
+    {
+        const auto it = m_sets.find( &node );
+        if( it == m_sets.end() )
+        {
+            return;
+        }
+
+        const detail::node_id_t id = detail::get_node_id( node );
+
+        auto& counts = m_counts[id];
+        for( const input_index_t input : it->second )
+        {
+            ++counts[input];
+        }
+
+        if( !m_history.empty() )
+        {
+            m_history.back().ticked.emplace_back( id, it->second );
+        }
+    }
+
+    void merge_into_successors( const detail::reactive_node& node, const input_set_t& set )
+    {
+        for( const detail::reactive_node* succ : node.successors )
+        {
+            merge( m_sets[succ], set );
+        }
+    }
+
+    static void merge( input_set_t& to, const input_set_t& from )
+    {
+        input_set_t result;
+        result.reserve( to.size() + from.size() );
+        std::set_union(
+            to.begin(), to.end(), from.begin(), from.end(), std::back_inserter( result ) );
+        to.swap( result );
+    }
+
+    size_t m_history_size;
+
+    std::vector<detail::node_id_t> m_inputs;
+    std::unordered_map<detail::node_id_t, input_index_t> m_input_indices;
+
+    std::deque<turn_entry> m_history;
+    std::unordered_map<detail::node_id_t, std::unordered_map<input_index_t, std::uint64_t>>
+        m_counts;
+
+    std::unordered_map<const detail::reactive_node*, input_set_t> m_sets;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_CAUSALITY_TRACKER_H_
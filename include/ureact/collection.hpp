@@ -0,0 +1,539 @@
+// collection.hpp - incremental operators over keyed reactive collections
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_COLLECTION_H_
+#define UREACT_COLLECTION_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Change of multiplicity of a record. Positive diff inserts copies, negative one removes them
+template <typename K, typename V>
+struct record_change
+{
+    K key;
+    V value;
+    long diff;
+};
+
+/// Changes of a collection made during a single turn
+template <typename K, typename V>
+struct collection_delta
+{
+    detail::turn_id_t turn = 0;  ///< Turn that produced the changes
+    std::uint64_t version = 0;   ///< Sequential number of the delta of its collection
+    long size = 0;               ///< Number of records in the collection after the delta
+    std::vector<record_change<K, V>> changes;
+};
+
+template <typename K, typename V>
+bool operator==( const collection_delta<K, V>& lhs, const collection_delta<K, V>& rhs )
+{
+    return lhs.turn == rhs.turn && lhs.version == rhs.version;
+}
+
+template <typename K, typename V>
+bool operator!=( const collection_delta<K, V>& lhs, const collection_delta<K, V>& rhs )
+{
+    return !( lhs == rhs );
+}
+
+/*! @brief Multiset of keyed records represented by the stream of its changes
+ *
+ *  The value of the signal is the delta of the last turn the collection changed in.
+ *  Operators consume deltas of their inputs and emit deltas, keeping indexed state
+ *  internally, so the work of a turn is proportional to the size of the change rather than
+ *  to the size of collections. Operators see only changes made after their creation,
+ *  so they should be created while their inputs are empty, otherwise std::logic_error
+ *  is thrown. While input collections exist, urgent transactions are merged only
+ *  at the end of running turns, so every delta is read by all operators.
+ */
+template <typename K, typename V>
+using collection = signal<collection_delta<K, V>>;
+
+
+namespace detail
+{
+
+/// Input collection node. Changes are accumulated during admission like var_node inputs
+template <typename K, typename V>
+class collection_input_node
+    : public signal_node<collection_delta<K, V>>
+    , public input_node_interface
+{
+public:
+    explicit collection_input_node( context& context )
+        : collection_input_node::signal_node( context )
+    {
+        collection_input_node::get_graph().add_delta_input();
+    }
+
+    ~collection_input_node() override
+    {
+        collection_input_node::get_graph().remove_delta_input();
+    }
+
+    // Nodes can't be copied
+    collection_input_node( const collection_input_node& ) = delete;
+    collection_input_node& operator=( const collection_input_node& ) = delete;
+    collection_input_node( collection_input_node&& ) noexcept = delete;
+    collection_input_node& operator=( collection_input_node&& ) noexcept = delete;
+
+    // LCOV_EXCL_START
+    void tick() override
+    {
+        assert( false && "Ticked collection_input_node" );
+    }
+    // LCOV_EXCL_STOP
+
+    template <typename F>
+    void request_modify_input( F& func )
+    {
+        collection_input_node::get_graph().modify_input( *this, func );
+    }
+
+    template <typename F>
+    void modify_input( F& func )
+    {
+        func( m_pending );
+    }
+
+    bool apply_input() override
+    {
+        if( m_pending.empty() )
+        {
+            return false;
+        }
+
+        this->m_value.changes.swap( m_pending );
+        m_pending.clear();
+        for( const auto& change : this->m_value.changes )
+        {
+            this->m_value.size += change.diff;
+        }
+        ++this->m_value.version;
+        this->m_value.turn = collection_input_node::get_graph().current_turn();
+
+        collection_input_node::get_graph().on_input_change( *this );
+        return true;
+    }
+
+private:
+    std::vector<record_change<K, V>> m_pending;
+};
+
+
+/// Reads deltas of an input collection that were not read yet
+template <typename K, typename V>
+class delta_reader
+{
+public:
+    explicit delta_reader( std::shared_ptr<signal_node<collection_delta<K, V>>> node )
+        : m_node( std::move( node ) )
+        , m_seen_version( m_node->value_ref().version )
+    {
+        if( m_node->value_ref().size != 0 )
+        {
+            throw std::logic_error( "Operator is attached to a non-empty collection" );
+        }
+    }
+
+    reactive_node& node() const
+    {
+        return *m_node;
+    }
+
+    /// Changes of a new delta or nullptr if there is none
+    const std::vector<record_change<K, V>>* fresh_changes()
+    {
+        const collection_delta<K, V>& delta = m_node->value_ref();
+        if( delta.version == m_seen_version )
+        {
+            return nullptr;
+        }
+        m_seen_version = delta.version;
+        return &delta.changes;
+    }
+
+private:
+    std::shared_ptr<signal_node<collection_delta<K, V>>> m_node;
+    std::uint64_t m_seen_version;
+};
+
+
+/// Base of operator nodes that emit deltas
+template <typename K, typename V>
+class delta_node : public signal_node<collection_delta<K, V>>
+{
+public:
+    explicit delta_node( context& context )
+        : delta_node::signal_node( context )
+    {}
+
+protected:
+    /// Publish changes accumulated in m_output if there are any
+    void publish()
+    {
+        if( m_output.empty() )
+        {
+            return;
+        }
+
+        this->m_value.changes.swap( m_output );
+        m_output.clear();
+        for( const auto& change : this->m_value.changes )
+        {
+            this->m_value.size += change.diff;
+        }
+        ++this->m_value.version;
+        this->m_value.turn = delta_node::get_graph().current_turn();
+
+        delta_node::get_graph().on_node_pulse( *this );
+    }
+
+    std::vector<record_change<K, V>> m_output;
+};
+
+
+/// Values with their multiplicities stored per key
+template <typename K, typename V>
+class multiset_index
+{
+public:
+    using entries_t = std::vector<std::pair<V, long>>;
+
+    void add( const K& key, const V& value, const long diff )
+    {
+        entries_t& entries = m_index[key];
+        for( auto it = entries.begin(); it != entries.end(); ++it )
+        {
+            if( it->first == value )
+            {
+                it->second += diff;
+                if( it->second == 0 )
+                {
+                    entries.erase( it );
+                    if( entries.empty() )
+                    {
+                        m_index.erase( key );
+                    }
+                }
+                return;
+            }
+        }
+        entries.emplace_back( value, diff );
+    }
+
+    /// Entries of the key or nullptr if there are none
+    const entries_t* find( const K& key ) const
+    {
+        const auto it = m_index.find( key );
+        return it != m_index.end() ? &it->second : nullptr;
+    }
+
+private:
+    std::unordered_map<K, entries_t> m_index;
+};
+
+
+template <typename K, typename V1, typename V2>
+class join_node : public delta_node<K, std::pair<V1, V2>>
+{
+public:
+    join_node( context& context,
+        std::shared_ptr<signal_node<collection_delta<K, V1>>> left,
+        std::shared_ptr<signal_node<collection_delta<K, V2>>> right )
+        : join_node::delta_node( context )
+        , m_left( std::move( left ) )
+        , m_right( std::move( right ) )
+    {
+        join_node::get_graph().on_node_attach( *this, m_left.node() );
+        join_node::get_graph().on_node_attach( *this, m_right.node() );
+    }
+
+    ~join_node() override
+    {
+        join_node::get_graph().on_node_detach( *this, m_right.node() );
+        join_node::get_graph().on_node_detach( *this, m_left.node() );
+    }
+
+    // Nodes can't be copied
+    join_node( const join_node& ) = delete;
+    join_node& operator=( const join_node& ) = delete;
+    join_node( join_node&& ) noexcept = delete;
+    join_node& operator=( join_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        // d(L x R) = dL x R + (L + dL) x dR
+        if( const auto* changes = m_left.fresh_changes() )
+        {
+            for( const auto& change : *changes )
+            {
+                if( const auto* matches = m_right_index.find( change.key ) )
+                {
+                    for( const auto& match : *matches )
+                    {
+                        emit( change.key, change.value, match.first, change.diff * match.second );
+                    }
+                }
+                m_left_index.add( change.key, change.value, change.diff );
+            }
+        }
+
+        if( const auto* changes = m_right.fresh_changes() )
+        {
+            for( const auto& change : *changes )
+            {
+                if( const auto* matches = m_left_index.find( change.key ) )
+                {
+                    for( const auto& match : *matches )
+                    {
+                        emit( change.key, match.first, change.value, match.second * change.diff );
+                    }
+                }
+                m_right_index.add( change.key, change.value, change.diff );
+            }
+        }
+
+        this->publish();
+    }
+
+private:
+    void emit( const K& key, const V1& left, const V2& right, const long diff )
+    {
+        this->m_output.push_back(
+            record_change<K, std::pair<V1, V2>>{ key, std::make_pair( left, right ), diff } );
+    }
+
+    delta_reader<K, V1> m_left;
+    delta_reader<K, V2> m_right;
+    multiset_index<K, V1> m_left_index;
+    multiset_index<K, V2> m_right_index;
+};
+
+
+template <typename K, typename V, typename G, typename F>
+class group_by_node : public delta_node<G, V>
+{
+public:
+    template <typename in_f>
+    group_by_node(
+        context& context, std::shared_ptr<signal_node<collection_delta<K, V>>> source, in_f&& func )
+        : group_by_node::delta_node( context )
+        , m_source( std::move( source ) )
+        , m_func( std::forward<in_f>( func ) )
+    {
+        group_by_node::get_graph().on_node_attach( *this, m_source.node() );
+    }
+
+    ~group_by_node() override
+    {
+        group_by_node::get_graph().on_node_detach( *this, m_source.node() );
+    }
+
+    // Nodes can't be copied
+    group_by_node( const group_by_node& ) = delete;
+    group_by_node& operator=( const group_by_node& ) = delete;
+    group_by_node( group_by_node&& ) noexcept = delete;
+    group_by_node& operator=( group_by_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        if( const auto* changes = m_source.fresh_changes() )
+        {
+            for( const auto& change : *changes )
+            {
+                this->m_output.push_back( record_change<G, V>{
+                    m_func( change.key, change.value ), change.value, change.diff } );
+            }
+        }
+
+        this->publish();
+    }
+
+private:
+    delta_reader<K, V> m_source;
+    F m_func;
+};
+
+
+template <typename K, typename V>
+class count_node : public delta_node<K, long>
+{
+public:
+    count_node( context& context, std::shared_ptr<signal_node<collection_delta<K, V>>> source )
+        : count_node::delta_node( context )
+        , m_source( std::move( source ) )
+    {
+        count_node::get_graph().on_node_attach( *this, m_source.node() );
+    }
+
+    ~count_node() override
+    {
+        count_node::get_graph().on_node_detach( *this, m_source.node() );
+    }
+
+    // Nodes can't be copied
+    count_node( const count_node& ) = delete;
+    count_node& operator=( const count_node& ) = delete;
+    count_node( count_node&& ) noexcept = delete;
+    count_node& operator=( count_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        const auto* changes = m_source.fresh_changes();
+        if( changes == nullptr )
+        {
+            return;
+        }
+
+        // Counts before the turn of keys changed in it
+        m_old_counts.clear();
+        for( const auto& change : *changes )
+        {
+            long& count = m_counts[change.key];
+            m_old_counts.emplace( change.key, count );
+            count += change.diff;
+        }
+
+        for( const auto& old : m_old_counts )
+        {
+            const auto it = m_counts.find( old.first );
+            const long count = it->second;
+
+            // Keys whose records are all gone are forgotten even if they had none before
+            if( count == 0 )
+            {
+                m_counts.erase( it );
+            }
+
+            if( count == old.second )
+            {
+                continue;
+            }
+
+            if( old.second != 0 )
+            {
+                this->m_output.push_back( record_change<K, long>{ old.first, old.second, -1 } );
+            }
+            if( count != 0 )
+            {
+                this->m_output.push_back( record_change<K, long>{ old.first, count, 1 } );
+            }
+        }
+
+        this->publish();
+    }
+
+private:
+    delta_reader<K, V> m_source;
+    std::unordered_map<K, long> m_counts;
+    std::unordered_map<K, long> m_old_counts;
+};
+
+} // namespace detail
+
+
+/// Input collection which records can be inserted and erased
+template <typename K, typename V>
+class collection_input : public collection<K, V>
+{
+public:
+    explicit collection_input( context& context )
+        : collection_input::signal( create_node( context ) )
+    {}
+
+    /// Insert copies of the record
+    void insert( const K& key, const V& value, const long count = 1 ) const
+    {
+        change( key, value, count );
+    }
+
+    /// Erase copies of the record
+    void erase( const K& key, const V& value, const long count = 1 ) const
+    {
+        change( key, value, -count );
+    }
+
+private:
+    using node_t = detail::collection_input_node<K, V>;
+
+    static std::shared_ptr<node_t> create_node( context& context )
+    {
+        UREACT_ALLOC_SCOPE( node_creation );
+        return std::make_shared<node_t>( context );
+    }
+
+    void change( const K& key, const V& value, const long diff ) const
+    {
+        auto func = [&]( std::vector<record_change<K, V>>& pending ) {
+            pending.push_back( record_change<K, V>{ key, value, diff } );
+        };
+        static_cast<node_t*>( get_node_ptr( *this ).get() )->request_modify_input( func );
+    }
+};
+
+/// Create an empty input collection
+template <typename K, typename V>
+auto make_collection( context& context ) -> collection_input<K, V>
+{
+    return collection_input<K, V>( context );
+}
+
+/// Collection of pairs of values of records with equal keys
+template <typename K, typename V1, typename V2>
+auto join( const collection<K, V1>& left, const collection<K, V2>& right )
+    -> collection<K, std::pair<V1, V2>>
+{
+    using node_t = detail::join_node<K, V1, V2>;
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return collection<K, std::pair<V1, V2>>( std::make_shared<node_t>(
+        left.get_context(), get_node_ptr( left ), get_node_ptr( right ) ) );
+}
+
+/// Collection of the same values keyed by func( key, value )
+template <typename K, typename V, typename in_f>
+auto group_by( const collection<K, V>& source, in_f&& func )
+    -> collection<typename std::decay<typename std::result_of<in_f( K, V )>::type>::type, V>
+{
+    using G = typename std::decay<typename std::result_of<in_f( K, V )>::type>::type;
+    using F = typename std::decay<in_f>::type;
+    using node_t = detail::group_by_node<K, V, G, F>;
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return collection<G, V>( std::make_shared<node_t>(
+        source.get_context(), get_node_ptr( source ), std::forward<in_f>( func ) ) );
+}
+
+/// Collection with one record ( key, number of records with the key ) per present key
+template <typename K, typename V>
+auto count( const collection<K, V>& source ) -> collection<K, long>
+{
+    using node_t = detail::count_node<K, V>;
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return collection<K, long>(
+        std::make_shared<node_t>( source.get_context(), get_node_ptr( source ) ) );
+}
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_COLLECTION_H_
@@ -0,0 +1,290 @@
+// context_pool.hpp - multiplexing of many small contexts onto a few worker threads
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_CONTEXT_POOL_H_
+#define UREACT_CONTEXT_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+class context_pool;
+
+/*! @brief Context driven by a context_pool
+ *
+ *  Changes are posted as transaction functions into the mailbox of the context.
+ *  All functions pending when a worker picks the context up are performed in a single
+ *  transaction, so observers see only their combined result.
+ *
+ *  The pool guarantees that at most one thread works with the context at a time,
+ *  so the context itself is single threaded. Graph of the context should be built
+ *  before the first post() or from posted functions.
+ *
+ *  Destructor waits until the context is not being processed and drops pending functions.
+ */
+class pooled_context
+{
+public:
+    explicit pooled_context( context_pool& pool )
+        : m_pool( pool )
+    {}
+
+    pooled_context( const pooled_context& ) = delete;
+    pooled_context& operator=( const pooled_context& ) = delete;
+    pooled_context( pooled_context&& ) noexcept = delete;
+    pooled_context& operator=( pooled_context&& ) noexcept = delete;
+
+    ~pooled_context();
+
+    /// Queue the transaction function to be performed by a worker of the pool
+    void post( std::function<void()> func );
+
+    /// Underlying context. Should be accessed only from posted functions
+    /// or while the pool is idle
+    context& get_context()
+    {
+        return m_context;
+    }
+
+private:
+    friend class context_pool;
+
+    enum class state : unsigned char
+    {
+        idle,
+        queued,
+        running
+    };
+
+    context_pool& m_pool;
+    context m_context;
+
+    // Guarded by the mutex of the pool
+    std::vector<std::function<void()>> m_mailbox;
+    state m_state = state::idle;
+};
+
+
+/*! @brief Runs transactions of many pooled_context instances on a fixed number of threads
+ *
+ *  Contexts with pending functions wait in a FIFO queue. A worker takes the first one,
+ *  performs all of its pending functions in one transaction and puts it back
+ *  to the end of the queue if new functions were posted meanwhile.
+ *
+ *  Exceptions thrown by transaction functions don't stop other functions of the transaction.
+ *  Exceptions thrown by propagation, e.g. by observers, drop the rest of its turn, while
+ *  the graph restores its state, so the context keeps working. Both kinds are passed
+ *  to the error handler on the worker thread, or ignored if there is none.
+ *  The handler shouldn't throw.
+ *  Pool should outlive its contexts.
+ */
+class context_pool
+{
+public:
+    using error_handler = std::function<void( std::exception_ptr )>;
+
+    explicit context_pool( const unsigned workers = std::thread::hardware_concurrency(),
+        error_handler on_error = nullptr )
+        : m_on_error( std::move( on_error ) )
+    {
+        for( unsigned i = 0; i < ( workers != 0 ? workers : 1 ); ++i )
+        {
+            m_threads.emplace_back( [this] { worker_loop(); } );
+        }
+    }
+
+    context_pool( const context_pool& ) = delete;
+    context_pool& operator=( const context_pool& ) = delete;
+    context_pool( context_pool&& ) noexcept = delete;
+    context_pool& operator=( context_pool&& ) noexcept = delete;
+
+    ~context_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_stopped = true;
+        }
+        m_ready_cv.notify_all();
+
+        for( auto& thread : m_threads )
+        {
+            thread.join();
+        }
+    }
+
+    /// Wait until all posted functions are performed
+    void wait_idle()
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_idle_cv.wait( lock, [this] { return m_ready.empty() && m_running == 0; } );
+    }
+
+    /// Number of transactions performed by the pool
+    std::uint64_t transactions() const
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        return m_transactions;
+    }
+
+private:
+    friend class pooled_context;
+
+    void post( pooled_context& ctx, std::function<void()>&& func )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            ctx.m_mailbox.push_back( std::move( func ) );
+            if( ctx.m_state != pooled_context::state::idle )
+            {
+                // Already queued or will be requeued by the worker running it
+                return;
+            }
+            ctx.m_state = pooled_context::state::queued;
+            m_ready.push_back( &ctx );
+        }
+        m_ready_cv.notify_one();
+    }
+
+    void remove( pooled_context& ctx )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_idle_cv.wait(
+            lock, [&] { return ctx.m_state != pooled_context::state::running; } );
+
+        if( ctx.m_state == pooled_context::state::queued )
+        {
+            for( auto it = m_ready.begin(); it != m_ready.end(); ++it )
+            {
+                if( *it == &ctx )
+                {
+                    m_ready.erase( it );
+                    break;
+                }
+            }
+        }
+        ctx.m_mailbox.clear();
+        ctx.m_state = pooled_context::state::idle;
+
+        if( m_ready.empty() && m_running == 0 )
+        {
+            m_idle_cv.notify_all();
+        }
+    }
+
+    void worker_loop()
+    {
+        std::vector<std::function<void()>> batch;
+        std::vector<std::exception_ptr> errors;
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        for( ;; )
+        {
+            m_ready_cv.wait( lock, [this] { return m_stopped || !m_ready.empty(); } );
+            if( m_stopped )
+            {
+                return;
+            }
+
+            pooled_context& ctx = *m_ready.front();
+            m_ready.pop_front();
+            ctx.m_state = pooled_context::state::running;
+            batch.swap( ctx.m_mailbox );
+            ++m_running;
+            ++m_transactions;
+
+            lock.unlock();
+
+            try
+            {
+                ctx.m_context.do_transaction( [&] {
+                    for( const auto& func : batch )
+                    {
+                        try
+                        {
+                            func();
+                        }
+                        catch( ... )
+                        {
+                            errors.push_back( std::current_exception() );
+                        }
+                    }
+                } );
+            }
+            catch( ... )
+            {
+                // Thrown by propagation, e.g. by an observer. The turn is already aborted
+                // by the graph, so the context can be used for the next transactions
+                errors.push_back( std::current_exception() );
+            }
+            batch.clear();
+
+            if( m_on_error )
+            {
+                for( const auto& error : errors )
+                {
+                    m_on_error( error );
+                }
+            }
+            errors.clear();
+
+            lock.lock();
+            --m_running;
+            if( ctx.m_mailbox.empty() )
+            {
+                ctx.m_state = pooled_context::state::idle;
+            }
+            else
+            {
+                ctx.m_state = pooled_context::state::queued;
+                m_ready.push_back( &ctx );
+                m_ready_cv.notify_one();
+            }
+
+            // Wakes destructors of contexts and waiters for idle pool
+            m_idle_cv.notify_all();
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready_cv;
+    std::condition_variable m_idle_cv;
+
+    std::deque<pooled_context*> m_ready;
+    unsigned m_running = 0;
+    bool m_stopped = false;
+    std::uint64_t m_transactions = 0;
+
+    error_handler m_on_error;
+
+    std::vector<std::thread> m_threads;
+};
+
+inline pooled_context::~pooled_context()
+{
+    m_pool.remove( *this );
+}
+
+inline void pooled_context::post( std::function<void()> func )
+{
+    m_pool.post( *this, std::move( func ) );
+}
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_CONTEXT_POOL_H_
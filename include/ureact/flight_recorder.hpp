@@ -0,0 +1,183 @@
+// flight_recorder.hpp - always-on binary recorder of propagation turns
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_FLIGHT_RECORDER_H_
+#define UREACT_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined( _WIN32 )
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Compact summary of a single propagation turn
+struct turn_record
+{
+    detail::turn_id_t turn_id;      ///< Sequential number of the turn in the context
+    std::uint64_t duration_ns;      ///< Duration of input application and propagation
+    detail::node_id_t slowest_node; ///< Id of the node with the longest tick or 0
+    std::uint64_t slowest_node_ns;  ///< Tick duration of the slowest node
+    std::uint32_t inputs_applied;   ///< Number of input nodes that changed their values
+    std::uint32_t nodes_ticked;     ///< Number of ticked nodes
+};
+
+
+/*! @brief Fixed-size ring buffer of turn_record for post-mortem latency analysis
+ *
+ *  Recording doesn't allocate.
+ *
+ *  Recording is done by the propagating thread only. Readers from other threads or from
+ *  signal handlers can use written() and raw_data() or write_dump() to get records
+ *  without locking. Records that are being overwritten during reading can be torn.
+ */
+class flight_recorder : private detail::scoped_turn_recorder
+{
+public:
+    /// Binary dump header. It is followed by count() turn_record entries
+    struct dump_header
+    {
+        char magic[4];             ///< "UFR1"
+        std::uint32_t record_size; ///< sizeof(turn_record)
+        std::uint64_t count;       ///< Number of records after the header
+    };
+
+    flight_recorder( context& ctx, const std::size_t capacity )
+        : scoped_turn_recorder( ctx )
+        , m_records( new turn_record[capacity]() )
+        , m_capacity( capacity )
+    {
+        assert( capacity > 0 );
+    }
+
+    flight_recorder( const flight_recorder& ) = delete;
+    flight_recorder& operator=( const flight_recorder& ) = delete;
+    flight_recorder( flight_recorder&& ) noexcept = delete;
+    flight_recorder& operator=( flight_recorder&& ) noexcept = delete;
+
+    /// Maximal number of stored records
+    std::size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /// Total number of records written since construction
+    std::uint64_t written() const
+    {
+        return m_written.load( std::memory_order_acquire );
+    }
+
+    /// Number of currently stored records
+    std::size_t count() const
+    {
+        const std::uint64_t n = written();
+        return n < m_capacity ? static_cast<std::size_t>( n ) : m_capacity;
+    }
+
+    /// Raw ring storage. Record number i is stored at index i % capacity()
+    const turn_record* raw_data() const
+    {
+        return m_records.get();
+    }
+
+    /// Return stored records from the oldest to the newest
+    std::vector<turn_record> snapshot() const
+    {
+        const std::uint64_t n = written();
+        const std::size_t size = n < m_capacity ? static_cast<std::size_t>( n ) : m_capacity;
+
+        std::vector<turn_record> result;
+        result.reserve( size );
+        for( std::uint64_t i = n - size; i != n; ++i )
+        {
+            result.push_back( m_records[static_cast<std::size_t>( i % m_capacity )] );
+        }
+        return result;
+    }
+
+    /// Write dump_header followed by stored records from the oldest to the newest
+    bool dump( std::FILE* file ) const
+    {
+        return write_records( [file]( const void* data, const std::size_t size ) {
+            return std::fwrite( data, 1, size, file ) == size;
+        } );
+    }
+
+    /// Same as dump(), but only write(2) is used, so it is async-signal-safe
+    bool write_dump( const int fd ) const
+    {
+        return write_records( [fd]( const void* data, const std::size_t size ) {
+            const char* bytes = static_cast<const char*>( data );
+            std::size_t left = size;
+            while( left != 0 )
+            {
+#if defined( _WIN32 )
+                const auto written = ::_write( fd, bytes, static_cast<unsigned>( left ) );
+#else
+                const auto written = ::write( fd, bytes, left );
+#endif
+                if( written <= 0 )
+                {
+                    return false;
+                }
+                bytes += written;
+                left -= static_cast<std::size_t>( written );
+            }
+            return true;
+        } );
+    }
+
+private:
+    // Write header and the ring directly as at most two contiguous segments
+    template <typename Write>
+    bool write_records( Write write ) const
+    {
+        const std::uint64_t n = written();
+        const std::size_t size = n < m_capacity ? static_cast<std::size_t>( n ) : m_capacity;
+        const auto first = static_cast<std::size_t>( ( n - size ) % m_capacity );
+        const std::size_t head = first + size <= m_capacity ? size : m_capacity - first;
+
+        const dump_header header{ { 'U', 'F', 'R', '1' },
+            static_cast<std::uint32_t>( sizeof( turn_record ) ),
+            static_cast<std::uint64_t>( size ) };
+
+        return write( &header, sizeof( header ) )
+            && ( head == 0 || write( &m_records[first], head * sizeof( turn_record ) ) )
+            && ( head == size || write( &m_records[0], ( size - head ) * sizeof( turn_record ) ) );
+    }
+
+    void on_turn_recorded( const detail::turn_summary& summary ) override
+    {
+        const std::uint64_t n = m_written.load( std::memory_order_relaxed );
+        m_records[static_cast<std::size_t>( n % m_capacity )] = turn_record{ summary.turn_id,
+            summary.duration_ns,
+            summary.slowest_node,
+            summary.slowest_node_ns,
+            summary.inputs_applied,
+            summary.nodes_ticked };
+        m_written.store( n + 1, std::memory_order_release );
+    }
+
+    std::unique_ptr<turn_record[]> m_records;
+    std::size_t m_capacity;
+    std::atomic<std::uint64_t> m_written{ 0 };
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_FLIGHT_RECORDER_H_
@@ -0,0 +1,114 @@
+// latency_tracker.hpp - end-to-end latency from input changes to observer invocations
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_LATENCY_TRACKER_H_
+#define UREACT_LATENCY_TRACKER_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "turn_metrics.hpp"
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Latency statistics of a single observer in nanoseconds
+struct observer_latency_stats
+{
+    std::string name;        ///< Debug name of the observer if any
+    std::uint64_t count = 0; ///< Number of invocations
+    std::uint64_t sum = 0;   ///< Sum of latencies
+    std::uint64_t max = 0;   ///< Maximal latency
+};
+
+
+/*! @brief Measures time from setting an input until an observer is invoked
+ *
+ *  Inputs are timestamped when their new value is set or modified, before waiting
+ *  for the graph lock, so both queueing time and time spent inside of a transaction function
+ *  are included. Latency of each observer invocation is measured relative to the oldest input
+ *  admitted for the turn, so it is the upper bound if inputs of the turn were set at different
+ *  times and the observer doesn't depend on the oldest one.
+ *
+ *  Statistics should not be read while a turn is running.
+ */
+class latency_tracker : private detail::scoped_turn_recorder
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit latency_tracker( context& ctx )
+        : scoped_turn_recorder( ctx )
+    {}
+
+    latency_tracker( const latency_tracker& ) = delete;
+    latency_tracker& operator=( const latency_tracker& ) = delete;
+    latency_tracker( latency_tracker&& ) noexcept = delete;
+    latency_tracker& operator=( latency_tracker&& ) noexcept = delete;
+
+    /// Latencies of all observer invocations
+    const hdr_histogram& latency() const
+    {
+        return m_latency;
+    }
+
+    /// Latency statistics per observer id
+    const std::unordered_map<detail::node_id_t, observer_latency_stats>& per_observer() const
+    {
+        return m_per_observer;
+    }
+
+    /// Forget all collected statistics
+    void reset()
+    {
+        m_latency.reset();
+        m_per_observer.clear();
+    }
+
+private:
+    void on_turn_recorded( const detail::turn_summary& /*summary*/ ) override
+    {}
+
+    void on_observer_invoke(
+        const detail::reactive_node& node, const clock::time_point admitted ) override
+    {
+        const auto latency = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - admitted )
+                .count() );
+
+        // Observers of the parallel observer phase are reported from pool threads
+        std::lock_guard<std::mutex> lock( m_mutex );
+
+        m_latency.record( latency );
+
+        observer_latency_stats& stats = m_per_observer[detail::get_node_id( node )];
+        if( stats.name.empty() && node.has_debug_name )
+        {
+            stats.name = detail::debug_names::get( node );
+        }
+        ++stats.count;
+        stats.sum += latency;
+        if( latency > stats.max )
+        {
+            stats.max = latency;
+        }
+    }
+
+    hdr_histogram m_latency;
+    std::unordered_map<detail::node_id_t, observer_latency_stats> m_per_observer;
+
+    std::mutex m_mutex;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_LATENCY_TRACKER_H_
@@ -0,0 +1,581 @@
+// parallel_executor.hpp - parallel ticking of propagation levels and invocation of observers
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_PARALLEL_EXECUTOR_H_
+#define UREACT_PARALLEL_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+namespace detail
+{
+
+inline unsigned default_workers_count()
+{
+    const unsigned threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads - 1 : 1;
+}
+
+/// Fork-join pool that runs tasks on its worker threads and on the calling thread
+class task_pool
+{
+public:
+    explicit task_pool( const unsigned workers )
+    {
+        for( unsigned i = 0; i < workers; ++i )
+        {
+            m_threads.emplace_back( [this] { worker_loop(); } );
+        }
+    }
+
+    task_pool( const task_pool& ) = delete;
+    task_pool& operator=( const task_pool& ) = delete;
+    task_pool( task_pool&& ) noexcept = delete;
+    task_pool& operator=( task_pool&& ) noexcept = delete;
+
+    ~task_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_stopped = true;
+        }
+        m_start_cv.notify_all();
+
+        for( auto& thread : m_threads )
+        {
+            thread.join();
+        }
+    }
+
+    unsigned workers() const
+    {
+        return static_cast<unsigned>( m_threads.size() );
+    }
+
+    /// Call func with every index in [0, count) and wait until all calls are finished.
+    /// Rethrow the first exception thrown by func
+    void run( const size_t count, const std::function<void( size_t )>& func )
+    {
+        m_func = &func;
+        m_count = count;
+        m_next.store( 0, std::memory_order_relaxed );
+        m_error = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            m_busy_workers = workers();
+            ++m_generation;
+        }
+        m_start_cv.notify_all();
+
+        run_available();
+
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_done_cv.wait( lock, [this] { return m_busy_workers == 0; } );
+        }
+
+        m_func = nullptr;
+
+        if( m_error )
+        {
+            std::rethrow_exception( m_error );
+        }
+    }
+
+private:
+    void run_available()
+    {
+        for( ;; )
+        {
+            const size_t i = m_next.fetch_add( 1, std::memory_order_relaxed );
+            if( i >= m_count )
+            {
+                return;
+            }
+
+            try
+            {
+                ( *m_func )( i );
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                if( !m_error )
+                {
+                    m_error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void worker_loop()
+    {
+        std::uint64_t seen_generation = 0;
+        for( ;; )
+        {
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_start_cv.wait(
+                    lock, [&] { return m_stopped || m_generation != seen_generation; } );
+                if( m_stopped )
+                {
+                    return;
+                }
+                seen_generation = m_generation;
+            }
+
+            run_available();
+
+            {
+                std::lock_guard<std::mutex> lock( m_mutex );
+                --m_busy_workers;
+            }
+            m_done_cv.notify_one();
+        }
+    }
+
+    const std::function<void( size_t )>* m_func = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next{ 0 };
+    std::exception_ptr m_error;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start_cv;
+    std::condition_variable m_done_cv;
+    std::uint64_t m_generation = 0;
+    unsigned m_busy_workers = 0;
+    bool m_stopped = false;
+};
+
+} // namespace detail
+
+
+/// Tuning parameters of parallel_executor
+struct parallel_executor_options
+{
+    /// Number of worker threads. The thread running the turn works too
+    unsigned workers = detail::default_workers_count();
+
+    /// Estimated level work in nanoseconds below which the level is ticked serially
+    float fork_threshold_ns = 50000.0f;
+
+    /// Minimal estimated work of a single task in nanoseconds
+    float min_task_ns = 10000.0f;
+
+    /// Weight of the newest measurement in the moving average of node costs
+    float smoothing = 0.25f;
+
+    /// Every resample_period-th serial level is measured to follow changes of node costs
+    unsigned resample_period = 64;
+};
+
+
+/*! @brief Ticks levels of a context on a thread pool when it is expected to pay off
+ *
+ *  Tick time of every parallel safe node is learned online as an exponentially weighted
+ *  moving average. Before each level the executor sums the estimates of its nodes.
+ *  Cheap levels are left to the ordinary serial loop of the graph, so parallelism
+ *  doesn't slow down turns made of cheap nodes. Expensive levels are split into tasks
+ *  of consecutive nodes with roughly equal estimated work not less than min_task_ns,
+ *  so cheap nodes are packed together instead of being dispatched one by one.
+ *
+ *  Levels containing nodes with unknown cost and every resample_period-th serial level
+ *  are ticked serially by the executor with time measurement.
+ *
+ *  Nodes that are not parallel safe, like observers and flatten nodes, are always ticked
+ *  on the thread running the turn after parallel tasks are finished.
+ *
+ *  Requires a context created with threading_policy::thread_safe_inputs.
+ *  Executor attaches to a context on construction and detaches on destruction,
+ *  so it should be destroyed before the context.
+ */
+class parallel_executor : private detail::level_executor
+{
+public:
+    explicit parallel_executor( context& ctx, parallel_executor_options options = {} )
+        : m_context( ctx )
+        , m_options( options )
+        , m_pool( options.workers )
+    {
+        _get_internals( m_context ).get_graph().set_level_executor( this );
+    }
+
+    parallel_executor( const parallel_executor& ) = delete;
+    parallel_executor& operator=( const parallel_executor& ) = delete;
+    parallel_executor( parallel_executor&& ) noexcept = delete;
+    parallel_executor& operator=( parallel_executor&& ) noexcept = delete;
+
+    ~parallel_executor() override
+    {
+        _get_internals( m_context ).get_graph().set_level_executor( nullptr );
+    }
+
+    /// Number of levels ticked on the thread pool
+    std::uint64_t forked_levels() const
+    {
+        return m_forked_levels;
+    }
+
+    /// Number of levels ticked serially, including measured ones
+    std::uint64_t serial_levels() const
+    {
+        return m_serial_levels;
+    }
+
+    /// Number of tasks dispatched to the thread pool
+    std::uint64_t tasks() const
+    {
+        return m_tasks_count;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct task
+    {
+        size_t begin;
+        size_t end;
+        std::vector<detail::reactive_node*> pulsed;
+    };
+
+    bool accepts_level( const std::vector<detail::reactive_node*>& nodes ) override
+    {
+        bool unknown = false;
+        m_level_work = 0.0f;
+        for( const auto* node : nodes )
+        {
+            if( node->is_parallel_safe() )
+            {
+                if( node->tick_cost == 0.0f )
+                {
+                    unknown = true;
+                }
+                m_level_work += node->tick_cost;
+            }
+        }
+
+        m_fork = m_level_work >= m_options.fork_threshold_ns && m_options.workers != 0;
+        m_measure = unknown || ( !m_fork && ++m_skipped_levels >= m_options.resample_period );
+
+        if( !m_fork && !m_measure )
+        {
+            ++m_serial_levels;
+            return false;
+        }
+
+        if( m_measure )
+        {
+            m_skipped_levels = 0;
+        }
+        return true;
+    }
+
+    void tick_level( const std::vector<detail::reactive_node*>& nodes,
+        std::vector<detail::reactive_node*>& pulsed ) override
+    {
+        m_nodes = &nodes;
+
+        if( m_fork && split_into_tasks() > 1 )
+        {
+            ++m_forked_levels;
+            run_tasks();
+
+            for( auto& t : m_tasks )
+            {
+                pulsed.insert( pulsed.end(), t.pulsed.begin(), t.pulsed.end() );
+            }
+        }
+        else
+        {
+            ++m_serial_levels;
+            for( auto* node : nodes )
+            {
+                if( node->is_parallel_safe() )
+                {
+                    tick_measured( *node );
+                }
+            }
+        }
+
+        // Nodes that should be ticked on the thread running the turn
+        for( auto* node : nodes )
+        {
+            if( !node->is_parallel_safe() )
+            {
+                detail::level_executor::tick( *node );
+            }
+        }
+
+        m_nodes = nullptr;
+    }
+
+    // Pack consecutive parallel safe nodes into tasks. Return number of tasks
+    size_t split_into_tasks()
+    {
+        const auto threads = static_cast<float>( m_options.workers + 1 );
+        float target = m_level_work / ( threads * 2.0f );
+        if( target < m_options.min_task_ns )
+        {
+            target = m_options.min_task_ns;
+        }
+
+        m_tasks.clear();
+
+        const std::vector<detail::reactive_node*>& nodes = *m_nodes;
+        size_t begin = 0;
+        float work = 0.0f;
+        for( size_t i = 0; i < nodes.size(); ++i )
+        {
+            work += nodes[i]->is_parallel_safe() ? nodes[i]->tick_cost : 0.0f;
+            if( work >= target || i + 1 == nodes.size() )
+            {
+                m_tasks.push_back( task{ begin, i + 1, {} } );
+                begin = i + 1;
+                work = 0.0f;
+            }
+        }
+
+        return m_tasks.size();
+    }
+
+    void run_tasks()
+    {
+        m_tasks_count += m_tasks.size();
+        m_pool.run( m_tasks.size(), [this]( const size_t i ) { run_task( m_tasks[i] ); } );
+    }
+
+    void run_task( task& t )
+    {
+        detail::level_executor::set_pulse_buffer( &t.pulsed );
+        try
+        {
+            for( size_t n = t.begin; n != t.end; ++n )
+            {
+                detail::reactive_node& node = *( *m_nodes )[n];
+                if( node.is_parallel_safe() )
+                {
+                    tick_measured( node );
+                }
+            }
+        }
+        catch( ... )
+        {
+            detail::level_executor::set_pulse_buffer( nullptr );
+            throw;
+        }
+        detail::level_executor::set_pulse_buffer( nullptr );
+    }
+
+    void tick_measured( detail::reactive_node& node ) const
+    {
+        const clock::time_point start = clock::now();
+        detail::level_executor::tick( node );
+        auto sample = static_cast<float>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - start )
+                .count() );
+
+        // Zero is reserved for unknown cost
+        if( sample < 1.0f )
+        {
+            sample = 1.0f;
+        }
+
+        node.tick_cost = node.tick_cost == 0.0f
+                           ? sample
+                           : node.tick_cost + m_options.smoothing * ( sample - node.tick_cost );
+    }
+
+    context& m_context;
+    parallel_executor_options m_options;
+
+    // State of the current level
+    const std::vector<detail::reactive_node*>* m_nodes = nullptr;
+    float m_level_work = 0.0f;
+    bool m_fork = false;
+    bool m_measure = false;
+    unsigned m_skipped_levels = 0;
+
+    // Tasks of the current level
+    std::vector<task> m_tasks;
+
+    detail::task_pool m_pool;
+
+    std::uint64_t m_forked_levels = 0;
+    std::uint64_t m_serial_levels = 0;
+    std::uint64_t m_tasks_count = 0;
+};
+
+
+/// Ordering constraints of observers invoked by parallel_observer_phase
+enum class observer_ordering
+{
+    unordered,          ///< Any observers can be invoked concurrently
+    same_subject_serial ///< Observers of the same subject are invoked serially in tick order
+};
+
+
+/// Tuning parameters of parallel_observer_phase
+struct parallel_observer_phase_options
+{
+    /// Number of worker threads. The thread running the turn works too
+    unsigned workers = detail::default_workers_count();
+
+    observer_ordering ordering = observer_ordering::same_subject_serial;
+
+    /// Turns with less changed observers invoke them serially
+    size_t min_parallel_observers = 2;
+};
+
+
+/*! @brief Invokes observers changed in a turn concurrently after propagation is finished
+ *
+ *  Instead of being invoked during propagation, observers are collected and invoked on
+ *  a thread pool when all nodes have their final values. Observers that requested detaching
+ *  are detached after all of them are invoked.
+ *
+ *  Observer functions invoked on worker threads should not change inputs of the context.
+ *
+ *  Requires a context created with threading_policy::thread_safe_inputs.
+ *  Phase attaches to a context on construction and detaches on destruction,
+ *  so it should be destroyed before the context.
+ */
+class parallel_observer_phase : private detail::observer_executor
+{
+public:
+    explicit parallel_observer_phase(
+        context& ctx, parallel_observer_phase_options options = {} )
+        : m_context( ctx )
+        , m_options( options )
+        , m_pool( options.workers )
+    {
+        _get_internals( m_context ).get_graph().set_observer_executor( this );
+    }
+
+    parallel_observer_phase( const parallel_observer_phase& ) = delete;
+    parallel_observer_phase& operator=( const parallel_observer_phase& ) = delete;
+    parallel_observer_phase( parallel_observer_phase&& ) noexcept = delete;
+    parallel_observer_phase& operator=( parallel_observer_phase&& ) noexcept = delete;
+
+    ~parallel_observer_phase() override
+    {
+        _get_internals( m_context ).get_graph().set_observer_executor( nullptr );
+    }
+
+    /// Number of phases that invoked observers on the thread pool
+    std::uint64_t parallel_phases() const
+    {
+        return m_parallel_phases;
+    }
+
+private:
+    struct group
+    {
+        std::vector<detail::observer_node*> observers;
+        std::vector<detail::observer_node*> detached;
+    };
+
+    void invoke_observers( const std::vector<detail::observer_node*>& observers,
+        std::vector<detail::observer_node*>& detached ) override
+    {
+        if( observers.size() < m_options.min_parallel_observers || m_pool.workers() == 0 )
+        {
+            for( auto* node : observers )
+            {
+                if( node->invoke() )
+                {
+                    detached.push_back( node );
+                }
+            }
+            return;
+        }
+
+        ++m_parallel_phases;
+
+        split_into_groups( observers );
+
+        m_pool.run( m_groups_count, [this]( const size_t i ) { invoke_group( m_groups[i] ); } );
+
+        for( size_t i = 0; i < m_groups_count; ++i )
+        {
+            detached.insert(
+                detached.end(), m_groups[i].detached.begin(), m_groups[i].detached.end() );
+        }
+    }
+
+    void split_into_groups( const std::vector<detail::observer_node*>& observers )
+    {
+        m_groups_count = 0;
+        m_group_of_subject.clear();
+
+        for( auto* node : observers )
+        {
+            size_t index = m_groups_count;
+            if( m_options.ordering == observer_ordering::same_subject_serial )
+            {
+                index = m_group_of_subject.emplace( node->subject(), m_groups_count )
+                            .first->second;
+            }
+
+            if( index == m_groups_count )
+            {
+                // Groups are reused between turns to keep their capacity
+                if( m_groups.size() == m_groups_count )
+                {
+                    m_groups.emplace_back();
+                }
+                m_groups[index].observers.clear();
+                m_groups[index].detached.clear();
+                ++m_groups_count;
+            }
+
+            m_groups[index].observers.push_back( node );
+        }
+    }
+
+    static void invoke_group( group& g )
+    {
+        for( auto* node : g.observers )
+        {
+            if( node->invoke() )
+            {
+                g.detached.push_back( node );
+            }
+        }
+    }
+
+    context& m_context;
+    parallel_observer_phase_options m_options;
+
+    std::vector<group> m_groups;
+    size_t m_groups_count = 0;
+    std::unordered_map<const detail::reactive_node*, size_t> m_group_of_subject;
+
+    detail::task_pool m_pool;
+
+    std::uint64_t m_parallel_phases = 0;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_PARALLEL_EXECUTOR_H_
@@ -0,0 +1,300 @@
+// parallelism_analyzer.hpp - critical path and parallelism potential of propagation turns
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_PARALLELISM_ANALYZER_H_
+#define UREACT_PARALLELISM_ANALYZER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Average work distribution of turns of the same type
+struct turn_type_report
+{
+    std::vector<detail::node_id_t> inputs; ///< Changed inputs that define the turn type
+    std::vector<std::string> input_names;  ///< Debug names of the inputs if any
+
+    std::uint64_t turns = 0;        ///< Number of turns of the type
+    double total_work = 0;          ///< Average sum of costs of ticked nodes
+    double critical_path = 0;       ///< Average cost of the most expensive dependency chain
+    std::vector<double> level_work; ///< Average sum of costs per level
+    std::vector<double> level_span; ///< Average cost of the most expensive node per level
+
+    /// Theoretical speedup on the given number of cores without any scheduling restrictions.
+    /// It is limited both by the critical path and by the total work divided between cores
+    double ideal_speedup( const unsigned cores ) const
+    {
+        const double parallel_time = std::max( critical_path, total_work / cores );
+        return parallel_time > 0 ? total_work / parallel_time : 1.0;
+    }
+
+    /// Theoretical speedup on the given number of cores if levels are processed one by one
+    /// and nodes of each level are processed in parallel
+    double level_speedup( const unsigned cores ) const
+    {
+        double parallel_time = 0;
+        for( size_t i = 0; i < level_work.size(); ++i )
+        {
+            parallel_time += std::max( level_span[i], level_work[i] / cores );
+        }
+        return parallel_time > 0 ? total_work / parallel_time : 1.0;
+    }
+};
+
+
+/*! @brief Estimates how much parallel propagation could speed up turns
+ *
+ *  For every turn it measures costs of ticked nodes (tick durations in nanoseconds unless
+ *  overridden with set_node_cost), restores dependencies between them from the graph
+ *  and computes total work, critical path length and per-level work distribution.
+ *  Results are aggregated per turn type, i.e. per set of changed inputs.
+ */
+class parallelism_analyzer : private detail::scoped_turn_listener
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit parallelism_analyzer( context& ctx )
+        : scoped_turn_listener( ctx )
+    {}
+
+    parallelism_analyzer( const parallelism_analyzer& ) = delete;
+    parallelism_analyzer& operator=( const parallelism_analyzer& ) = delete;
+    parallelism_analyzer( parallelism_analyzer&& ) noexcept = delete;
+    parallelism_analyzer& operator=( parallelism_analyzer&& ) noexcept = delete;
+
+    /// Use the given cost of the node instead of measured tick duration
+    void set_node_cost( const detail::node_id_t node, const double cost )
+    {
+        m_cost_overrides[node] = cost;
+    }
+
+    /// Return statistics per turn type. The most frequent types go first
+    std::vector<turn_type_report> report() const
+    {
+        std::vector<turn_type_report> result;
+        for( const auto& p : m_turn_types )
+        {
+            const turn_type_stats& stats = p.second;
+            const auto turns = static_cast<double>( stats.turns );
+
+            turn_type_report entry;
+            entry.inputs = p.first;
+            entry.input_names = stats.input_names;
+            entry.turns = stats.turns;
+            entry.total_work = stats.total_work / turns;
+            entry.critical_path = stats.critical_path / turns;
+            for( size_t i = 0; i < stats.level_work.size(); ++i )
+            {
+                entry.level_work.push_back( stats.level_work[i] / turns );
+                entry.level_span.push_back( stats.level_span[i] / turns );
+            }
+            result.push_back( std::move( entry ) );
+        }
+
+        std::stable_sort( result.begin(),
+            result.end(),
+            []( const turn_type_report& lhs, const turn_type_report& rhs ) {
+                return lhs.turns > rhs.turns;
+            } );
+
+        return result;
+    }
+
+    /// Return report() as text with speedups for the given numbers of cores
+    std::string report_text( const std::vector<unsigned>& cores = { 2, 4, 8 } ) const
+    {
+        std::string result;
+        for( const turn_type_report& entry : report() )
+        {
+            result += "inputs:";
+            for( size_t i = 0; i < entry.inputs.size(); ++i )
+            {
+                result += ' ';
+                result += entry.input_names[i].empty() ? "#" + std::to_string( entry.inputs[i] )
+                                                       : entry.input_names[i];
+            }
+            result += "\n  turns: " + std::to_string( entry.turns );
+            result += "\n  total_work: " + std::to_string( entry.total_work );
+            result += "\n  critical_path: " + std::to_string( entry.critical_path );
+            result += "\n  level_work:";
+            for( const double work : entry.level_work )
+            {
+                result += ' ' + std::to_string( work );
+            }
+            for( const unsigned n : cores )
+            {
+                result += "\n  speedup x" + std::to_string( n ) + ": ideal "
+                        + std::to_string( entry.ideal_speedup( n ) ) + ", level by level "
+                        + std::to_string( entry.level_speedup( n ) );
+            }
+            result += '\n';
+        }
+        return result;
+    }
+
+    /// Forget all collected statistics
+    void reset()
+    {
+        m_turn_types.clear();
+    }
+
+private:
+    struct ticked_node
+    {
+        const detail::reactive_node* node;
+        int level;
+        double cost;
+        double start;
+    };
+
+    struct turn_type_stats
+    {
+        std::vector<std::string> input_names;
+        std::uint64_t turns = 0;
+        double total_work = 0;
+        double critical_path = 0;
+        std::vector<double> level_work;
+        std::vector<double> level_span;
+    };
+
+    void on_turn_begin( detail::turn_id_t /*turn*/ ) override
+    {
+        m_inputs.clear();
+        m_ticked.clear();
+        m_ticked_index.clear();
+    }
+
+    void on_turn_end( detail::turn_id_t /*turn*/ ) override
+    {
+        if( m_ticked.empty() )
+        {
+            return;
+        }
+
+        // Input can be applied several times in a turn, e.g. when an observer changes it again
+        std::sort( m_inputs.begin(), m_inputs.end() );
+        m_inputs.erase( std::unique( m_inputs.begin(), m_inputs.end() ), m_inputs.end() );
+
+        turn_type_stats& stats = m_turn_types[m_inputs];
+        if( stats.turns++ == 0 )
+        {
+            for( const detail::node_id_t input : m_inputs )
+            {
+                const auto it = m_input_names.find( input );
+                stats.input_names.emplace_back( it != m_input_names.end() ? it->second : "" );
+            }
+        }
+
+        // Nodes are ticked in topological order, so every node is finished
+        // before its successors are started
+        double total_work = 0;
+        double critical_path = 0;
+        for( const ticked_node& ticked : m_ticked )
+        {
+            const double finish = ticked.start + ticked.cost;
+            total_work += ticked.cost;
+            critical_path = std::max( critical_path, finish );
+
+            for( const detail::reactive_node* succ : ticked.node->successors )
+            {
+                const auto it = m_ticked_index.find( succ );
+                if( it != m_ticked_index.end() )
+                {
+                    double& succ_start = m_ticked[it->second].start;
+                    succ_start = std::max( succ_start, finish );
+                }
+            }
+
+            const auto level = static_cast<size_t>( ticked.level );
+            if( stats.level_work.size() <= level )
+            {
+                stats.level_work.resize( level + 1 );
+                stats.level_span.resize( level + 1 );
+            }
+            stats.level_work[level] += ticked.cost;
+            m_level_span.resize( stats.level_span.size() );
+            m_level_span[level] = std::max( m_level_span[level], ticked.cost );
+        }
+
+        for( size_t i = 0; i < m_level_span.size(); ++i )
+        {
+            stats.level_span[i] += m_level_span[i];
+            m_level_span[i] = 0;
+        }
+
+        stats.total_work += total_work;
+        stats.critical_path += critical_path;
+    }
+
+    void on_input_applied( const detail::reactive_node& node ) override
+    {
+        const detail::node_id_t id = detail::get_node_id( node );
+        m_inputs.push_back( id );
+        if( node.has_debug_name )
+        {
+            m_input_names[id] = detail::debug_names::get( node );
+        }
+    }
+
+    void on_tick_begin( const detail::reactive_node& /*node*/ ) override
+    {
+        m_tick_starts.push_back( clock::now() );
+    }
+
+    void on_tick_end( const detail::reactive_node& node ) override
+    {
+        const auto elapsed = clock::now() - m_tick_starts.back();
+        m_tick_starts.pop_back();
+        double cost = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count() );
+
+        const auto override_it = m_cost_overrides.find( detail::get_node_id( node ) );
+        if( override_it != m_cost_overrides.end() )
+        {
+            cost = override_it->second;
+        }
+
+        // Node can be ticked several times per turn if its level is changed
+        const auto it = m_ticked_index.find( &node );
+        if( it != m_ticked_index.end() )
+        {
+            m_ticked[it->second].cost += cost;
+            return;
+        }
+
+        m_ticked_index.emplace( &node, m_ticked.size() );
+        m_ticked.push_back( ticked_node{ &node, node.level, cost, 0 } );
+    }
+
+    std::unordered_map<detail::node_id_t, double> m_cost_overrides;
+    std::unordered_map<detail::node_id_t, std::string> m_input_names;
+    std::map<std::vector<detail::node_id_t>, turn_type_stats> m_turn_types;
+
+    std::vector<detail::node_id_t> m_inputs;
+    std::vector<ticked_node> m_ticked;
+    std::unordered_map<const detail::reactive_node*, size_t> m_ticked_index;
+    std::vector<double> m_level_span;
+
+    // Observer starting a nested turn is ticked around the ticks of that turn,
+    // so its cost includes them
+    std::vector<clock::time_point> m_tick_starts;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_PARALLELISM_ANALYZER_H_
@@ -0,0 +1,182 @@
+// path_profiler.hpp - attribution of tick time to dependency paths in folded-stack format
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_PATH_PROFILER_H_
+#define UREACT_PATH_PROFILER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/*! @brief Attributes tick time of nodes to chains of dependencies that caused the ticks
+ *
+ *  During a turn every node remembers the first predecessor whose change scheduled it.
+ *  Following these links back gives a chain from a changed input to the ticked node,
+ *  e.g. "price;spread;quote_observer". Tick durations in nanoseconds are summed per chain
+ *  and can be exported in folded-stack format accepted by flamegraph tools.
+ *
+ *  Nodes are named by their debug names (see set_debug_name) or by "#<node id>".
+ */
+class path_profiler : private detail::scoped_turn_listener
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit path_profiler( context& ctx )
+        : scoped_turn_listener( ctx )
+    {}
+
+    path_profiler( const path_profiler& ) = delete;
+    path_profiler& operator=( const path_profiler& ) = delete;
+    path_profiler( path_profiler&& ) noexcept = delete;
+    path_profiler& operator=( path_profiler&& ) noexcept = delete;
+
+    /// Accumulated tick time in nanoseconds per dependency chain.
+    /// Chains are rendered as in folded(), so each call builds a new map
+    std::map<std::string, std::uint64_t> stacks() const
+    {
+        std::map<std::string, std::uint64_t> result;
+        for( const auto& p : m_stacks )
+        {
+            result[render( p.first )] += p.second;
+        }
+        return result;
+    }
+
+    /// Return stacks() in folded-stack format: "input;intermediate;node <nanoseconds>" per line.
+    /// Separators ';' and ' ' as well as line breaks in names are replaced with '_'
+    std::string folded() const
+    {
+        std::string result;
+        for( const auto& p : stacks() )
+        {
+            result += p.first;
+            result += ' ';
+            result += std::to_string( p.second );
+            result += '\n';
+        }
+        return result;
+    }
+
+    /// Forget all collected stacks
+    void reset()
+    {
+        m_stacks.clear();
+        m_names.clear();
+    }
+
+private:
+    using path_t = std::vector<detail::node_id_t>;
+
+    std::string render( const path_t& path ) const
+    {
+        std::string result;
+        for( const detail::node_id_t id : path )
+        {
+            if( !result.empty() )
+            {
+                result += ';';
+            }
+
+            const auto it = m_names.find( id );
+            if( it == m_names.end() )
+            {
+                result += '#';
+                result += std::to_string( id );
+                continue;
+            }
+
+            for( const char c : it->second )
+            {
+                result += ( c == ';' || c == ' ' || c == '\n' || c == '\r' ) ? '_' : c;
+            }
+        }
+        return result;
+    }
+
+    void on_turn_begin( detail::turn_id_t /*turn*/ ) override
+    {
+        m_causes.clear();
+    }
+
+    void on_input_applied( const detail::reactive_node& node ) override
+    {
+        mark_successors( node );
+    }
+
+    void on_node_pulse( const detail::reactive_node& node ) override
+    {
+        mark_successors( node );
+    }
+
+    void on_tick_begin( const detail::reactive_node& /*node*/ ) override
+    {
+        m_tick_starts.push_back( clock::now() );
+    }
+
+    void on_tick_end( const detail::reactive_node& node ) override
+    {
+        const auto elapsed = clock::now() - m_tick_starts.back();
+        m_tick_starts.pop_back();
+
+        // Chain is built from the ticked node back to the input, so it is reversed
+        m_path.clear();
+        for( const detail::reactive_node* cur = &node; cur != nullptr; )
+        {
+            m_path.push_back( detail::get_node_id( *cur ) );
+
+            // Names are remembered, so chains of destroyed nodes can still be rendered
+            if( cur->has_debug_name && m_names.find( m_path.back() ) == m_names.end() )
+            {
+                m_names.emplace( m_path.back(), detail::debug_names::get( *cur ) );
+            }
+
+            const auto it = m_causes.find( cur );
+            cur = it != m_causes.end() ? it->second : nullptr;
+        }
+        std::reverse( m_path.begin(), m_path.end() );
+
+        auto it = m_stacks.find( m_path );
+        if( it == m_stacks.end() )
+        {
+            it = m_stacks.emplace( m_path, 0 ).first;
+        }
+        it->second += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count() );
+    }
+
+    void mark_successors( const detail::reactive_node& node )
+    {
+        for( const detail::reactive_node* succ : node.successors )
+        {
+            m_causes.emplace( succ, &node );
+        }
+    }
+
+    std::map<path_t, std::uint64_t> m_stacks;
+    std::unordered_map<detail::node_id_t, std::string> m_names;
+
+    std::unordered_map<const detail::reactive_node*, const detail::reactive_node*> m_causes;
+    path_t m_path;
+
+    // Ticks can nest, e.g. when a node ticks inside of another node's tick
+    std::vector<clock::time_point> m_tick_starts;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_PATH_PROFILER_H_
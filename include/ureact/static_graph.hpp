@@ -0,0 +1,444 @@
+// static_graph.hpp - reactive graphs fully described by types with compile-time scheduling
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_STATIC_GRAPH_H_
+#define UREACT_STATIC_GRAPH_H_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Input node of a static graph identified by tag type
+template <typename tag_t, typename T>
+struct static_input
+{
+    using tag = tag_t;
+};
+
+/// Node of a static graph that holds the result of F applied to values of dependencies.
+/// F should be a default constructible function object
+template <typename tag_t, typename F, typename... dep_tags_t>
+struct static_signal
+{
+    using tag = tag_t;
+};
+
+/// Node of a static graph that calls F with values of dependencies when any of them changes.
+/// F should be a default constructible function object
+template <typename tag_t, typename F, typename... dep_tags_t>
+struct static_observer
+{
+    using tag = tag_t;
+};
+
+/// Node of a static graph that sets value of the dependency to a connected var_signal
+template <typename tag_t, typename dep_tag_t>
+struct static_output
+{
+    using tag = tag_t;
+};
+
+namespace detail
+{
+
+struct static_input_kind
+{};
+
+struct static_signal_kind
+{};
+
+struct static_observer_kind
+{};
+
+struct static_output_kind
+{};
+
+template <size_t... I>
+struct static_index_sequence
+{};
+
+template <size_t N, size_t... I>
+struct make_static_index_sequence : make_static_index_sequence<N - 1, N - 1, I...>
+{};
+
+template <size_t... I>
+struct make_static_index_sequence<0, I...>
+{
+    using type = static_index_sequence<I...>;
+};
+
+/// Index sequence [from, to)
+template <size_t from, size_t to, size_t... I>
+struct make_static_index_range : make_static_index_range<from, to - 1, to - 1, I...>
+{};
+
+template <size_t from, size_t... I>
+struct make_static_index_range<from, from, I...>
+{
+    using type = static_index_sequence<I...>;
+};
+
+template <bool... values>
+struct static_any;
+
+template <>
+struct static_any<> : std::false_type
+{};
+
+template <bool first, bool... rest>
+struct static_any<first, rest...>
+    : std::integral_constant<bool, first || static_any<rest...>::value>
+{};
+
+// Index of node with the given tag in the nodes tuple
+
+template <typename tag, typename nodes_t, size_t i = 0>
+struct static_index_of;
+
+template <typename tag, size_t i>
+struct static_index_of<tag, std::tuple<>, i>
+{
+    static_assert(
+        sizeof( tag ) == 0, "Node with the given tag is not declared in the static graph" );
+};
+
+template <typename tag, typename first_t, typename... rest_t, size_t i>
+struct static_index_of<tag, std::tuple<first_t, rest_t...>, i>
+    : std::conditional<std::is_same<tag, typename first_t::tag>::value,
+          std::integral_constant<size_t, i>,
+          static_index_of<tag, std::tuple<rest_t...>, i + 1>>::type
+{};
+
+// Traits of a node declaration in context of the whole graph:
+//   value_t          - type of the value held by the node (void if none)
+//   deps             - static_index_sequence of dependency indices
+//   depends_on<i>    - if node transitively depends on node i
+
+template <typename nodes_t,
+    size_t k,
+    typename node_t = typename std::tuple_element<k, nodes_t>::type>
+struct static_node_traits;
+
+template <typename nodes_t, size_t k, typename... dep_tags_t>
+struct static_deps_traits
+{
+    using deps = static_index_sequence<static_index_of<dep_tags_t, nodes_t>::value...>;
+
+    static_assert( !static_any<( static_index_of<dep_tags_t, nodes_t>::value >= k )...>::value,
+        "Dependencies of a static graph node should be declared before it" );
+
+    template <size_t i>
+    struct depends_on
+        : static_any<( static_index_of<dep_tags_t, nodes_t>::value == i )...,
+              static_node_traits<nodes_t,
+                  static_index_of<dep_tags_t, nodes_t>::value>::template depends_on<i>::value...>
+    {};
+};
+
+template <typename nodes_t, size_t k, typename tag_t, typename T>
+struct static_node_traits<nodes_t, k, static_input<tag_t, T>>
+{
+    using value_t = T;
+    using deps = static_index_sequence<>;
+
+    template <size_t i>
+    struct depends_on : std::false_type
+    {};
+
+    struct storage
+    {
+        using kind = static_input_kind;
+
+        T value;
+    };
+};
+
+template <typename nodes_t, size_t k, typename tag_t, typename F, typename... dep_tags_t>
+struct static_node_traits<nodes_t, k, static_signal<tag_t, F, dep_tags_t...>>
+    : static_deps_traits<nodes_t, k, dep_tags_t...>
+{
+    using value_t = typename std::decay<typename std::result_of<F(
+        const typename static_node_traits<nodes_t,
+            static_index_of<dep_tags_t, nodes_t>::value>::value_t&... )>::type>::type;
+
+    struct storage
+    {
+        using kind = static_signal_kind;
+        using func_t = F;
+
+        value_t value;
+        F func;
+    };
+};
+
+template <typename nodes_t, size_t k, typename tag_t, typename F, typename... dep_tags_t>
+struct static_node_traits<nodes_t, k, static_observer<tag_t, F, dep_tags_t...>>
+    : static_deps_traits<nodes_t, k, dep_tags_t...>
+{
+    using value_t = void;
+
+    struct storage
+    {
+        using kind = static_observer_kind;
+        using func_t = F;
+
+        F func;
+    };
+};
+
+template <typename nodes_t, size_t k, typename tag_t, typename dep_tag_t>
+struct static_node_traits<nodes_t, k, static_output<tag_t, dep_tag_t>>
+    : static_deps_traits<nodes_t, k, dep_tag_t>
+{
+    using value_t = void;
+
+    struct storage
+    {
+        using kind = static_output_kind;
+
+        var_signal<typename static_node_traits<nodes_t,
+            static_index_of<dep_tag_t, nodes_t>::value>::value_t>
+            target;
+    };
+};
+
+} // namespace detail
+
+
+/*! @brief Reactive graph declared as a type
+ *
+ *  Nodes are declared with static_input, static_signal, static_observer and static_output
+ *  and identified by tag types. Declaration order is the topological order: dependencies
+ *  of every node should be declared before it, which is checked at compile time.
+ *
+ *  For every input, nodes transitively depending on it are known at compile time, so
+ *  set<tag>() is a straight-line sequence of recalculations of these nodes in declaration
+ *  order. Nodes are recalculated only if any of their dependencies changed. Values and
+ *  functions are stored inline, there are no heap allocations, virtual calls or queues.
+ *
+ *  Values of dependencies are passed to functions as const references.
+ *  All signals are evaluated on construction, observers are not called.
+ *
+ *  Use bind_input() and static_output nodes to connect a static graph with a context.
+ */
+template <typename... nodes_t>
+class static_graph
+{
+    using nodes = std::tuple<nodes_t...>;
+
+    enum : size_t
+    {
+        nodes_count = sizeof...( nodes_t )
+    };
+
+    template <size_t k>
+    using traits = detail::static_node_traits<nodes, k>;
+
+    template <typename tag>
+    using index_of = detail::static_index_of<tag, nodes>;
+
+    template <typename sequence_t>
+    struct storage_tuple;
+
+    template <size_t... I>
+    struct storage_tuple<detail::static_index_sequence<I...>>
+    {
+        using type = std::tuple<typename traits<I>::storage...>;
+    };
+
+public:
+    /// Value type of the node with the given tag
+    template <typename tag>
+    using value_t = typename traits<index_of<tag>::value>::value_t;
+
+    static_graph()
+    {
+        update_all( typename detail::make_static_index_sequence<nodes_count>::type() );
+    }
+
+    static_graph( const static_graph& ) = delete;
+    static_graph& operator=( const static_graph& ) = delete;
+    static_graph( static_graph&& ) noexcept = delete;
+    static_graph& operator=( static_graph&& ) noexcept = delete;
+
+    ~static_graph() = default;
+
+    /// Set new value of the input and update all nodes depending on it
+    template <typename tag, typename V>
+    void set( V&& new_value )
+    {
+        enum : size_t
+        {
+            i = index_of<tag>::value
+        };
+
+        static_assert( std::is_same<typename std::tuple_element<i, nodes>::type,
+                           static_input<tag, value_t<tag>>>::value,
+            "Only inputs of a static graph can be set" );
+
+        auto& value = std::get<i>( m_storage ).value;
+        if( detail::equals( value, new_value ) )
+        {
+            return;
+        }
+        value = std::forward<V>( new_value );
+
+        bool changed[nodes_count] = {};
+        changed[i] = true;
+        update_dependent<i>(
+            changed, typename detail::make_static_index_range<i + 1, nodes_count>::type() );
+    }
+
+    /// Return value of the input or signal with the given tag
+    template <typename tag>
+    const value_t<tag>& get() const
+    {
+        return std::get<index_of<tag>::value>( m_storage ).value;
+    }
+
+    /// Return function object of the signal or observer with the given tag
+    template <typename tag>
+    typename traits<index_of<tag>::value>::storage::func_t& function()
+    {
+        return std::get<index_of<tag>::value>( m_storage ).func;
+    }
+
+    /// Connect output with the given tag to the var_signal. The current value is set immediately
+    template <typename tag, typename S>
+    void connect( const var_signal<S>& target )
+    {
+        enum : size_t
+        {
+            k = index_of<tag>::value
+        };
+
+        auto& storage = std::get<k>( m_storage );
+        storage.target = target;
+        apply( storage, typename traits<k>::deps(), detail::static_output_kind() );
+    }
+
+private:
+    template <size_t... K>
+    void update_all( detail::static_index_sequence<K...> )
+    {
+        const int dummy[]
+            = { 0, ( evaluate( std::get<K>( m_storage ), typename traits<K>::deps() ), 0 )... };
+        (void)dummy;
+    }
+
+    template <size_t i, size_t... K>
+    void update_dependent( bool* changed, detail::static_index_sequence<K...> )
+    {
+        const int dummy[] = { 0,
+            ( update_node<K>( changed,
+                  std::integral_constant<bool, traits<K>::template depends_on<i>::value>(),
+                  typename traits<K>::deps(),
+                  std::get<K>( m_storage ) ),
+                0 )... };
+        (void)dummy;
+    }
+
+    // Nodes that don't depend on the changed input generate no code
+    template <size_t k, typename deps_t, typename storage_t>
+    void update_node( bool* /*changed*/, std::false_type, deps_t, storage_t& /*storage*/ )
+    {}
+
+    template <size_t k, size_t... D, typename storage_t>
+    void update_node( bool* changed,
+        std::true_type,
+        detail::static_index_sequence<D...> deps,
+        storage_t& storage )
+    {
+        bool any_changed = false;
+        const bool dep_changed[] = { changed[D]... };
+        for( const bool c : dep_changed )
+        {
+            any_changed = any_changed || c;
+        }
+
+        if( any_changed )
+        {
+            changed[k] = apply( storage, deps, typename storage_t::kind() );
+        }
+    }
+
+    // Initial evaluation of signals and outputs
+    template <typename storage_t, typename deps_t>
+    void evaluate( storage_t& storage, deps_t deps )
+    {
+        evaluate( storage, deps, typename storage_t::kind() );
+    }
+
+    template <typename storage_t, size_t... D>
+    void evaluate(
+        storage_t& storage, detail::static_index_sequence<D...>, detail::static_signal_kind )
+    {
+        storage.value = storage.func( std::get<D>( m_storage ).value... );
+    }
+
+    template <typename storage_t, typename deps_t, typename kind_t>
+    void evaluate( storage_t& /*storage*/, deps_t, kind_t )
+    {}
+
+    // Recalculate signal and report if its value changed
+    template <typename storage_t, size_t... D>
+    bool apply(
+        storage_t& storage, detail::static_index_sequence<D...>, detail::static_signal_kind )
+    {
+        auto new_value = storage.func( std::get<D>( m_storage ).value... );
+        if( detail::equals( storage.value, new_value ) )
+        {
+            return false;
+        }
+        storage.value = std::move( new_value );
+        return true;
+    }
+
+    template <typename storage_t, size_t... D>
+    bool apply(
+        storage_t& storage, detail::static_index_sequence<D...>, detail::static_observer_kind )
+    {
+        storage.func( std::get<D>( m_storage ).value... );
+        return false;
+    }
+
+    template <typename storage_t, size_t D>
+    bool apply( storage_t& storage, detail::static_index_sequence<D>, detail::static_output_kind )
+    {
+        if( storage.target.is_valid() )
+        {
+            storage.target <<= std::get<D>( m_storage ).value;
+        }
+        return false;
+    }
+
+    typename storage_tuple<typename detail::make_static_index_sequence<nodes_count>::type>::type
+        m_storage;
+};
+
+
+/// Set the input of the static graph to the current value of the source signal
+/// and on each of its changes. Binding is kept until the returned scoped observer is destroyed.
+/// The graph is referenced by the binding, so it should not outlive the graph
+template <typename tag, typename graph_t, typename S>
+auto bind_input( graph_t& graph, const signal<S>& source ) -> scoped_observer
+{
+    graph.template set<tag>( source.value() );
+    return observe( source, [&graph]( const S& value ) { graph.template set<tag>( value ); } );
+}
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_STATIC_GRAPH_H_
@@ -0,0 +1,215 @@
+// top_k.hpp - incremental top-k and sorted views over a collection of signals
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_TOP_K_H_
+#define UREACT_TOP_K_H_
+
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+namespace detail
+{
+
+/// Node that keeps indices of signals with the greatest keys in an ordered set.
+/// Only keys of changed predecessors are recomputed, so a turn costs O(log n)
+/// per changed signal. The result is rebuilt in O(k) only if an old or a new position
+/// of a changed entry is within the top
+template <typename S, typename F>
+class top_k_node : public signal_node<std::vector<size_t>>
+{
+public:
+    using key_t = typename std::decay<typename std::result_of<F( const S& )>::type>::type;
+
+    template <typename in_f>
+    top_k_node( context& context,
+        std::vector<std::shared_ptr<signal_node<S>>> inputs,
+        const size_t k,
+        in_f&& key )
+        : top_k_node::signal_node( context )
+        , m_inputs( std::move( inputs ) )
+        , m_k( k )
+        , m_key( std::forward<in_f>( key ) )
+    {
+        this->tracks_changed_predecessors = true;
+
+        m_keys.reserve( m_inputs.size() );
+        for( size_t i = 0; i < m_inputs.size(); ++i )
+        {
+            m_keys.push_back( m_key( m_inputs[i]->value_ref() ) );
+            m_order.emplace( m_keys.back(), i );
+            m_indices.emplace( m_inputs[i].get(), i );
+        }
+
+        collect( this->m_value );
+
+        for( const auto& input : m_inputs )
+        {
+            top_k_node::get_graph().on_node_attach( *this, *input );
+        }
+    }
+
+    ~top_k_node() override
+    {
+        for( const auto& input : m_inputs )
+        {
+            top_k_node::get_graph().on_node_detach( *this, *input );
+        }
+    }
+
+    // Nodes can't be copied
+    top_k_node( const top_k_node& ) = delete;
+    top_k_node& operator=( const top_k_node& ) = delete;
+    top_k_node( top_k_node&& ) noexcept = delete;
+    top_k_node& operator=( top_k_node&& ) noexcept = delete;
+
+    void on_predecessor_changed( const reactive_node& predecessor ) override
+    {
+        const auto range = m_indices.equal_range( &predecessor );
+        for( auto it = range.first; it != range.second; ++it )
+        {
+            m_changed.push_back( it->second );
+        }
+    }
+
+    void tick() override
+    {
+        bool top_changed = false;
+        for( const size_t i : m_changed )
+        {
+            key_t new_key = m_key( m_inputs[i]->value_ref() );
+            if( !equals( m_keys[i], new_key ) )
+            {
+                entry_t entry( std::move( m_keys[i] ), i );
+                top_changed = top_changed || in_top( entry );
+                m_order.erase( entry );
+
+                entry.first = std::move( new_key );
+                top_changed = top_changed || in_top( entry );
+                m_keys[i] = entry.first;
+                m_order.insert( std::move( entry ) );
+            }
+        }
+        m_changed.clear();
+
+        if( !top_changed )
+        {
+            return;
+        }
+
+        // Pulse only if membership or order of the top changed
+        collect( m_buffer );
+        if( !equals( this->m_value, m_buffer ) )
+        {
+            this->m_value.swap( m_buffer );
+            top_k_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+private:
+    using entry_t = std::pair<key_t, size_t>;
+
+    // Greater keys first, equal keys ordered by index
+    struct entry_order
+    {
+        bool operator()( const entry_t& lhs, const entry_t& rhs ) const
+        {
+            if( lhs.first < rhs.first )
+            {
+                return false;
+            }
+            if( rhs.first < lhs.first )
+            {
+                return true;
+            }
+            return lhs.second < rhs.second;
+        }
+    };
+
+    // Collect the top and remember its last entry
+    void collect( std::vector<size_t>& result )
+    {
+        result.clear();
+        m_last = m_order.end();
+        for( auto it = m_order.begin(); it != m_order.end() && result.size() < m_k; ++it )
+        {
+            result.push_back( it->second );
+            m_last = it;
+        }
+
+        // While all entries are in the top, any change can reorder it
+        if( m_order.size() <= m_k )
+        {
+            m_last = m_order.end();
+        }
+    }
+
+    // Whether the entry is or would be in the top. Changes of entries outside of it
+    // don't change the top, so m_last stays valid until the top is collected again
+    bool in_top( const entry_t& entry ) const
+    {
+        return m_last == m_order.end() || !entry_order()( *m_last, entry );
+    }
+
+    std::vector<std::shared_ptr<signal_node<S>>> m_inputs;
+    size_t m_k;
+    F m_key;
+
+    std::vector<key_t> m_keys;
+    std::set<entry_t, entry_order> m_order;
+    std::unordered_multimap<const reactive_node*, size_t> m_indices;
+
+    std::vector<size_t> m_changed;
+
+    // Last entry of the top, or end() if all entries are in it
+    typename std::set<entry_t, entry_order>::const_iterator m_last;
+
+    // Storage for the next result, swapped with m_value when the result changes
+    std::vector<size_t> m_buffer;
+};
+
+} // namespace detail
+
+
+/// Create a signal with indices of at most k signals with the greatest key( value ),
+/// ordered by descending key. Equal keys are ordered by index.
+/// With k equal to the number of signals, it is a sorted view of the whole collection.
+/// Each turn costs O(log n) per changed signal, and the result changes only when
+/// membership or order of the top changes
+template <typename S, typename in_f>
+auto top_k( const std::vector<signal<S>>& signals, const size_t k, in_f&& key )
+    -> signal<std::vector<size_t>>
+{
+    using F = typename std::decay<in_f>::type;
+
+    assert( !signals.empty() && "top_k requires at least one signal" );
+    context& context = signals.front().get_context();
+
+    std::vector<std::shared_ptr<detail::signal_node<S>>> inputs;
+    inputs.reserve( signals.size() );
+    for( const auto& s : signals )
+    {
+        inputs.push_back( get_node_ptr( s ) );
+    }
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return signal<std::vector<size_t>>( std::make_shared<detail::top_k_node<S, F>>(
+        context, std::move( inputs ), k, std::forward<in_f>( key ) ) );
+}
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_TOP_K_H_
@@ -0,0 +1,366 @@
+// turn_metrics.hpp - turn latency histograms with Prometheus text exposition
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_TURN_METRICS_H_
+#define UREACT_TURN_METRICS_H_
+
+#include <chrono>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+
+#if defined( _WIN32 )
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/*! @brief Histogram with logarithmic buckets that are linearly divided into sub-buckets
+ *
+ *  It is done in HDR histogram fashion: values below 64 are counted exactly and bigger values
+ *  are stored with relative error below 1/32. The whole uint64_t range is covered.
+ *  Recording doesn't allocate.
+ */
+class hdr_histogram
+{
+public:
+    enum : int
+    {
+        sub_bucket_bits = 5,
+        sub_bucket_count = 1 << sub_bucket_bits,
+        exact_count = sub_bucket_count * 2,
+        bucket_count = exact_count + ( 63 - sub_bucket_bits ) * sub_bucket_count
+    };
+
+    hdr_histogram() = default;
+
+    /// Add value to the histogram
+    void record( const std::uint64_t value )
+    {
+        ++m_counts[bucket_index( value )];
+        ++m_total_count;
+        m_sum += value;
+        if( value > m_max )
+        {
+            m_max = value;
+        }
+    }
+
+    /// Forget all recorded values
+    void reset()
+    {
+        *this = hdr_histogram{};
+    }
+
+    std::uint64_t count() const
+    {
+        return m_total_count;
+    }
+
+    std::uint64_t sum() const
+    {
+        return m_sum;
+    }
+
+    std::uint64_t max() const
+    {
+        return m_max;
+    }
+
+    /// Return number of recorded values that are less or equal to the given one.
+    /// Values of the sub-bucket that contains the given value are counted only if the whole
+    /// sub-bucket is below or equal to it, so the result is never too high. It is exact for
+    /// values below exact_count and for sub-bucket upper bounds
+    std::uint64_t count_at_or_below( const std::uint64_t value ) const
+    {
+        int last = bucket_index( value );
+        if( bucket_upper_bound( last ) > value )
+        {
+            --last;
+        }
+
+        std::uint64_t result = 0;
+        for( int i = 0; i <= last; ++i )
+        {
+            result += m_counts[i];
+        }
+        return result;
+    }
+
+    /// Return the highest value equivalent to the value at given quantile in [0, 1] range
+    std::uint64_t value_at_quantile( const double quantile ) const
+    {
+        if( m_total_count == 0 )
+        {
+            return 0;
+        }
+
+        // Rank of the value is rounded up, so p50 of 3 values is the 2nd one
+        const double rank = quantile * static_cast<double>( m_total_count );
+        auto wanted = static_cast<std::uint64_t>( rank );
+        if( static_cast<double>( wanted ) < rank )
+        {
+            ++wanted;
+        }
+        if( wanted == 0 )
+        {
+            wanted = 1;
+        }
+
+        std::uint64_t accumulated = 0;
+        for( int i = 0; i < bucket_count; ++i )
+        {
+            accumulated += m_counts[i];
+            if( accumulated >= wanted )
+            {
+                const std::uint64_t upper = bucket_upper_bound( i );
+                return upper < m_max ? upper : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    static int bucket_index( const std::uint64_t value )
+    {
+        if( value < static_cast<std::uint64_t>( exact_count ) )
+        {
+            return static_cast<int>( value );
+        }
+
+        const int msb = most_significant_bit( value );
+        const int shift = msb - sub_bucket_bits;
+        const auto sub_bucket = static_cast<int>( ( value >> shift ) - sub_bucket_count );
+        return exact_count + ( msb - sub_bucket_bits - 1 ) * sub_bucket_count + sub_bucket;
+    }
+
+    static std::uint64_t bucket_upper_bound( const int index )
+    {
+        if( index < exact_count )
+        {
+            return static_cast<std::uint64_t>( index );
+        }
+
+        const int msb = ( index - exact_count ) / sub_bucket_count + sub_bucket_bits + 1;
+        const int sub_bucket = ( index - exact_count ) % sub_bucket_count;
+        const int shift = msb - sub_bucket_bits;
+        const std::uint64_t lower = static_cast<std::uint64_t>( sub_bucket_count + sub_bucket )
+                                 << shift;
+        return lower + ( ( std::uint64_t( 1 ) << shift ) - 1 );
+    }
+
+private:
+    static int most_significant_bit( std::uint64_t value )
+    {
+        int result = 0;
+        for( int step = 32; step != 0; step /= 2 )
+        {
+            if( value >> step )
+            {
+                value >>= step;
+                result += step;
+            }
+        }
+        return result;
+    }
+
+    std::uint64_t m_counts[bucket_count] = {};
+    std::uint64_t m_total_count = 0;
+    std::uint64_t m_sum = 0;
+    std::uint64_t m_max = 0;
+};
+
+
+namespace detail
+{
+
+/// Append histogram in Prometheus text format. Bucket bounds are fixed 1-2-5 series
+/// from first_le to last_le, so series names don't change between scrapes
+inline void append_prometheus_histogram( std::string& out,
+    const char* name,
+    const char* help,
+    const hdr_histogram& histogram,
+    const std::uint64_t first_le,
+    const std::uint64_t last_le )
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " histogram\n";
+
+    for( std::uint64_t decade = first_le; decade <= last_le; decade *= 10 )
+    {
+        for( const std::uint64_t multiplier : { 1, 2, 5 } )
+        {
+            const std::uint64_t le = decade * multiplier;
+            if( le > last_le )
+            {
+                break;
+            }
+
+            out += name;
+            out += "_bucket{le=\"";
+            out += std::to_string( le );
+            out += "\"} ";
+            out += std::to_string( histogram.count_at_or_below( le ) );
+            out += '\n';
+        }
+    }
+
+    out += name;
+    out += "_bucket{le=\"+Inf\"} ";
+    out += std::to_string( histogram.count() );
+    out += '\n';
+
+    out += name;
+    out += "_sum ";
+    out += std::to_string( histogram.sum() );
+    out += '\n';
+
+    out += name;
+    out += "_count ";
+    out += std::to_string( histogram.count() );
+    out += '\n';
+}
+
+} // namespace detail
+
+
+/*! @brief Collects distributions of turn duration, ticked nodes per turn and observer latency
+ *
+ *  Observer latency is the time from the admission of the oldest input of the turn,
+ *  including waiting for the graph lock, to the moment observer function is invoked.
+ *
+ *  Recording doesn't allocate. Histograms should not be read while a turn is running.
+ */
+class turn_metrics : private detail::scoped_turn_recorder
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit turn_metrics( context& ctx )
+        : scoped_turn_recorder( ctx )
+    {}
+
+    turn_metrics( const turn_metrics& ) = delete;
+    turn_metrics& operator=( const turn_metrics& ) = delete;
+    turn_metrics( turn_metrics&& ) noexcept = delete;
+    turn_metrics& operator=( turn_metrics&& ) noexcept = delete;
+
+    /// Turn durations in nanoseconds
+    const hdr_histogram& turn_duration() const
+    {
+        return m_turn_duration;
+    }
+
+    /// Numbers of ticked nodes per turn
+    const hdr_histogram& ticked_nodes() const
+    {
+        return m_ticked_nodes;
+    }
+
+    /// Delays between input admission and observer invocations in nanoseconds
+    const hdr_histogram& observer_latency() const
+    {
+        return m_observer_latency;
+    }
+
+    void reset()
+    {
+        m_turn_duration.reset();
+        m_ticked_nodes.reset();
+        m_observer_latency.reset();
+    }
+
+    /// Render all metrics in Prometheus text exposition format
+    /// Exposed bucket bounds are 100ns - 10s for durations and 1 - 1M for ticked nodes
+    std::string to_prometheus() const
+    {
+        std::string result;
+        detail::append_prometheus_histogram( result,
+            "ureact_turn_duration_nanoseconds",
+            "Duration of propagation turns.",
+            m_turn_duration,
+            100,
+            10000000000 );
+        detail::append_prometheus_histogram( result,
+            "ureact_turn_ticked_nodes",
+            "Number of nodes ticked per turn.",
+            m_ticked_nodes,
+            1,
+            1000000 );
+        detail::append_prometheus_histogram( result,
+            "ureact_observer_latency_nanoseconds",
+            "Delay from input admission to observer invocation.",
+            m_observer_latency,
+            100,
+            10000000000 );
+        return result;
+    }
+
+    /// Write metrics in Prometheus text exposition format to the file descriptor
+    bool write_prometheus( const int fd ) const
+    {
+        const std::string text = to_prometheus();
+
+        const char* data = text.data();
+        std::size_t left = text.size();
+        while( left != 0 )
+        {
+#if defined( _WIN32 )
+            const auto written = ::_write( fd, data, static_cast<unsigned>( left ) );
+#else
+            const auto written = ::write( fd, data, left );
+#endif
+            if( written <= 0 )
+            {
+                return false;
+            }
+            data += written;
+            left -= static_cast<std::size_t>( written );
+        }
+        return true;
+    }
+
+private:
+    void on_turn_recorded( const detail::turn_summary& summary ) override
+    {
+        m_turn_duration.record( summary.duration_ns );
+        m_ticked_nodes.record( summary.nodes_ticked );
+    }
+
+    void on_observer_invoke(
+        const detail::reactive_node& /*node*/, const clock::time_point admitted ) override
+    {
+        const auto elapsed = clock::now() - admitted;
+        const auto latency = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count() );
+
+        // Observers of the parallel observer phase are reported from pool threads
+        std::lock_guard<std::mutex> lock( m_observer_mutex );
+        m_observer_latency.record( latency );
+    }
+
+    hdr_histogram m_turn_duration;
+    hdr_histogram m_ticked_nodes;
+    hdr_histogram m_observer_latency;
+
+    std::mutex m_observer_mutex;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_TURN_METRICS_H_
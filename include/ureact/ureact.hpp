@@ -17,11 +17,22 @@
 #ifndef UREACT_UREACT_H_
 #define UREACT_UREACT_H_
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -29,6 +40,10 @@
 #    include <algorithm>
 #endif
 
+#ifdef UREACT_ENABLE_USDT
+#    include <sys/sdt.h>
+#endif
+
 //==================================================================================================
 // [[section]] Preprocessor feature detections
 // Mostly based on https://github.com/fmtlib/fmt/blob/master/include/fmt/core.h
@@ -74,6 +89,35 @@
 #    endif
 #endif
 
+// Static tracepoints (USDT) for system tracers like bpftrace, SystemTap or perf.
+// They are compiled in only if UREACT_ENABLE_USDT is defined and cost nothing otherwise.
+// Probes are placed in "ureact" provider:
+//   turn_begin(turn_id), turn_end(turn_id)
+//   level_begin(level, nodes_count), level_end(level)
+//   tick_begin(node_id, level), tick_end(node_id, level)
+//   input_applied(node_id)
+//   observer_invoke(node_id, subject_node_id), observer_detach(node_id)
+#ifdef UREACT_ENABLE_USDT
+#    define UREACT_PROBE1( name, a1 ) DTRACE_PROBE1( ureact, name, a1 )
+#    define UREACT_PROBE2( name, a1, a2 ) DTRACE_PROBE2( ureact, name, a1, a2 )
+#else
+#    define UREACT_PROBE1( name, a1 )
+#    define UREACT_PROBE2( name, a1, a2 )
+#endif
+
+// Allocation profiling scopes. If UREACT_ENABLE_ALLOC_PROFILING is defined, internal code
+// tags the current thread with the subsystem it allocates memory for, so an allocation hook
+// (see alloc_profiler.hpp) can attribute heap allocations to subsystems.
+// Scopes cost nothing otherwise. The definition should be the same in all translation units.
+// The macro is kept defined, so headers that add nodes can tag their allocations too.
+#ifdef UREACT_ENABLE_ALLOC_PROFILING
+#    define UREACT_ALLOC_SCOPE( subsystem )                                                        \
+        const ::ureact::detail::alloc_scope ureact_alloc_scope_(                                   \
+            ::ureact::detail::alloc_subsystem::subsystem )
+#else
+#    define UREACT_ALLOC_SCOPE( subsystem )
+#endif
+
 #define UREACT_VERSION_NAMESPACE_NAME v0
 
 #ifndef UREACT_BEGIN_NAMESPACE
@@ -130,6 +174,30 @@ enum class observer_action
     stop_and_detach ///< Need to stop observing
 };
 
+/// Priority of a transaction
+enum class turn_priority
+{
+    normal, ///< Wait until the running turn is finished
+    urgent  ///< Merge into the running turn at the next level boundary
+};
+
+/// Synchronization guarantees of a context. Chosen once on context construction
+enum class threading_policy
+{
+    /// All access from a single thread. No synchronization cost
+    single_threaded,
+
+    /// Inputs can be changed and transactions can be done from any thread.
+    /// Admission of inputs and propagation turns are serialized by a mutex.
+    /// Values of signals should be read from observers or while no turn is running.
+    /// The graph itself is not synchronized: nodes and observers should be created and
+    /// destroyed, and diagnostic tools attached, either from inside of a turn or while no
+    /// turn is running, e.g. by building the graph on one thread before inputs are shared.
+    /// Level and observer executors (see parallel_executor.hpp) that tick independent
+    /// nodes of a turn on several threads can be used only with this policy
+    thread_safe_inputs
+};
+
 namespace detail
 {
 
@@ -440,6 +508,83 @@ struct decay_input<var_signal<T>>
 };
 
 
+/// Base of functions that can be called concurrently from worker threads of a level executor
+struct parallel_safe_tag
+{};
+
+/// Wrapper that marks a user function as parallel safe. See ureact::parallel_safe()
+template <typename F>
+class parallel_safe_function : public parallel_safe_tag
+{
+public:
+    template <typename in_f,
+        class = typename std::enable_if<!is_same_decay<in_f, parallel_safe_function>::value>::type>
+    explicit parallel_safe_function( in_f&& func )
+        : m_func( std::forward<in_f>( func ) )
+    {}
+
+    template <typename... args_t>
+    auto operator()( args_t&&... args )
+        -> decltype( std::declval<F&>()( std::forward<args_t>( args )... ) )
+    {
+        return m_func( std::forward<args_t>( args )... );
+    }
+
+    template <typename... args_t>
+    auto operator()( args_t&&... args ) const
+        -> decltype( std::declval<const F&>()( std::forward<args_t>( args )... ) )
+    {
+        return m_func( std::forward<args_t>( args )... );
+    }
+
+private:
+    F m_func;
+};
+
+/// Functions of nodes are called on worker threads only if they are parallel safe.
+/// User functions are marked with ureact::parallel_safe(), functors of built-in operators
+/// only call operators of the value types, so they are parallel safe as is
+template <typename F>
+struct is_parallel_safe_function : std::is_base_of<parallel_safe_tag, F>
+{};
+
+template <template <typename, typename> class functor_binary_op,
+    typename lhs_t,
+    typename rhs_t,
+    typename F>
+struct is_parallel_safe_function<bind_left<functor_binary_op, lhs_t, rhs_t, F>>
+    : is_parallel_safe_function<F>
+{};
+
+template <template <typename, typename> class functor_binary_op,
+    typename lhs_t,
+    typename rhs_t,
+    typename F>
+struct is_parallel_safe_function<bind_right<functor_binary_op, lhs_t, rhs_t, F>>
+    : is_parallel_safe_function<F>
+{};
+
+/// Dependency of function_op. Nested ops are parallel safe if their functions are
+template <typename T>
+struct is_parallel_safe_dependency : T::parallel_safe
+{};
+
+template <typename T>
+struct is_parallel_safe_dependency<std::shared_ptr<T>> : std::true_type
+{};
+
+template <typename... deps_t>
+struct are_parallel_safe_dependencies : std::true_type
+{};
+
+template <typename dep_t, typename... deps_t>
+struct are_parallel_safe_dependencies<dep_t, deps_t...>
+    : std::integral_constant<bool,
+          is_parallel_safe_dependency<dep_t>::value
+              && are_parallel_safe_dependencies<deps_t...>::value>
+{};
+
+
 #if defined( __clang__ ) && defined( __clang_minor__ )
 #    pragma clang diagnostic push
 #    pragma clang diagnostic ignored "-Wfloat-equal"
@@ -477,18 +622,276 @@ bool equals( const signal<L>& lhs, const signal<R>& rhs )
 namespace detail
 {
 
+/// Unique identifier of a reactive node. Identifiers are never reused within a process,
+/// so diagnostic tools can safely key statistics by them.
+using node_id_t = std::uint64_t;
+
+/// Sequential number of a propagation turn in a context.
+using turn_id_t = std::uint64_t;
+
 class reactive_node
 {
 public:
+    reactive_node()
+        : id( next_id() )
+    {}
+
     int level{ 0 };
     int new_level{ 0 };
     bool queued{ false };
 
+    /// Critical observers are invoked before non-critical observers of the same turn
+    bool critical{ false };
+
+    /// If set, on_predecessor_changed() is called for every changed predecessor
+    bool tracks_changed_predecessors{ false };
+
+    /// Set if the node has a name in debug_names
+    bool has_debug_name{ false };
+
+    /// Moving average of tick time in nanoseconds maintained by level executors. 0 if unknown
+    float tick_cost{ 0 };
+
+    /// See node_id_t
+    node_id_t id;
+
+    /// Generation of the transaction batch reach the node was last added to.
+    /// See transaction_batch
+    std::uint64_t batch_mark{ 0 };
+
     std::vector<reactive_node*> successors;
 
-    virtual ~reactive_node() = default;
+    virtual ~reactive_node();
 
     virtual void tick() = 0;
+
+    /// Called before the node is scheduled because the given predecessor has changed.
+    /// Lets nodes with many predecessors update only the affected part of their state
+    virtual void on_predecessor_changed( const reactive_node& /*predecessor*/ )
+    {}
+
+    /// Called when a new value of the given input predecessor is admitted, if the node
+    /// is registered with react_graph::add_admission_recorder(). Return true to be ticked
+    /// in the turn that applies the value even if the input doesn't change
+    virtual bool on_predecessor_admitted( const reactive_node& /*predecessor*/ )
+    {
+        return false;
+    }
+
+    /// Return true if the node can be ticked concurrently with other nodes of its level.
+    /// Such a node should only read its predecessors and report changes via on_node_pulse
+    virtual bool is_parallel_safe() const
+    {
+        return false;
+    }
+
+private:
+    static node_id_t next_id()
+    {
+        static std::atomic<node_id_t> last_id{ 0 };
+        return last_id.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    }
+};
+
+
+inline node_id_t get_node_id( const reactive_node& node )
+{
+    return node.id;
+}
+
+
+/// Optional names of nodes used by diagnostic tools. Names are kept out of nodes,
+/// because only a few nodes are named, and should outlive the nodes
+class debug_names
+{
+public:
+    static void set( reactive_node& node, const char* name )
+    {
+        registry& r = instance();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        if( name != nullptr )
+        {
+            r.names[node.id] = name;
+        }
+        else
+        {
+            r.names.erase( node.id );
+        }
+        node.has_debug_name = name != nullptr;
+    }
+
+    /// Return name of the node or nullptr if it isn't set. Unnamed nodes are checked lock-free
+    static const char* get( const reactive_node& node )
+    {
+        if( !node.has_debug_name )
+        {
+            return nullptr;
+        }
+
+        registry& r = instance();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        const auto it = r.names.find( node.id );
+        return it != r.names.end() ? it->second : nullptr;
+    }
+
+    static void forget( const reactive_node& node )
+    {
+        registry& r = instance();
+        std::lock_guard<std::mutex> lock( r.mutex );
+        r.names.erase( node.id );
+    }
+
+private:
+    struct registry
+    {
+        std::mutex mutex;
+        std::unordered_map<node_id_t, const char*> names;
+    };
+
+    // Never destroyed, so nodes can outlive static objects destruction
+    static registry& instance()
+    {
+        static registry* r = new registry();
+        return *r;
+    }
+};
+
+inline reactive_node::~reactive_node()
+{
+    if( has_debug_name )
+    {
+        debug_names::forget( *this );
+    }
+}
+
+
+/// Internal subsystems heap allocations are attributed to. See UREACT_ALLOC_SCOPE
+enum class alloc_subsystem
+{
+    user,                  ///< Allocations outside of tagged scopes
+    node_creation,         ///< Allocation of nodes
+    successors,            ///< Growth of successors lists
+    scheduler_queue,       ///< Queues of scheduled nodes, changed inputs and detached observers
+    observer_registration, ///< Allocation and registration of observers
+    value_copy,            ///< Stores of new values into var_node and signal_op_node
+    count
+};
+
+#ifdef UREACT_ENABLE_ALLOC_PROFILING
+
+inline alloc_subsystem& current_alloc_subsystem_ref()
+{
+    static thread_local alloc_subsystem subsystem = alloc_subsystem::user;
+    return subsystem;
+}
+
+/// Tags the current thread with the subsystem until the end of the scope
+class alloc_scope
+{
+public:
+    explicit alloc_scope( const alloc_subsystem subsystem )
+        : m_previous( current_alloc_subsystem_ref() )
+    {
+        current_alloc_subsystem_ref() = subsystem;
+    }
+
+    alloc_scope( const alloc_scope& ) = delete;
+    alloc_scope& operator=( const alloc_scope& ) = delete;
+
+    ~alloc_scope()
+    {
+        current_alloc_subsystem_ref() = m_previous;
+    }
+
+private:
+    alloc_subsystem m_previous;
+};
+
+#endif
+
+/// Return the subsystem the current thread allocates memory for
+inline alloc_subsystem current_alloc_subsystem()
+{
+#ifdef UREACT_ENABLE_ALLOC_PROFILING
+    return current_alloc_subsystem_ref();
+#else
+    return alloc_subsystem::user;
+#endif
+}
+
+
+/// Interface to receive notifications about propagation turns.
+/// It is used by diagnostic tools and does nothing by default.
+class turn_listener
+{
+public:
+    virtual ~turn_listener() = default;
+
+    /// Called before input changes of a turn are applied
+    virtual void on_turn_begin( turn_id_t /*turn*/ )
+    {}
+
+    /// Called after propagation of a turn is finished
+    virtual void on_turn_end( turn_id_t /*turn*/ )
+    {}
+
+    /// Called when input node changed its value during the current turn
+    virtual void on_input_applied( const reactive_node& /*node*/ )
+    {}
+
+    /// Called right before node is ticked
+    virtual void on_tick_begin( const reactive_node& /*node*/ )
+    {}
+
+    /// Called right after node is ticked
+    virtual void on_tick_end( const reactive_node& /*node*/ )
+    {}
+
+    /// Called when ticked node changed its value and is about to notify its successors
+    virtual void on_node_pulse( const reactive_node& /*node*/ )
+    {}
+
+    /// Called right before observer function is invoked
+    virtual void on_observer_invoke( const reactive_node& /*node*/ )
+    {}
+};
+
+
+/// Summary of a single propagation turn. See turn_recorder
+struct turn_summary
+{
+    turn_id_t turn_id = 0;             ///< Sequential number of the turn
+    std::uint64_t duration_ns = 0;     ///< Duration of input application and propagation
+    node_id_t slowest_node = 0;        ///< Id of the node with the longest tick or 0
+    std::uint64_t slowest_node_ns = 0; ///< Tick duration of the slowest node
+    std::uint32_t inputs_applied = 0;  ///< Number of input nodes that changed
+    std::uint32_t nodes_ticked = 0;    ///< Number of ticked nodes
+
+    /// Time the oldest input of the turn was set, taken before waiting for the graph lock.
+    /// Turn start if inputs were admitted before recording started or inside of the turn
+    std::chrono::steady_clock::time_point admitted;
+};
+
+
+/// Interface of always-on recorders of turn summaries.
+/// Unlike turn_listener, the recorder is called only once per turn and per invoked observer,
+/// while inputs and ticks are counted and timed by the graph itself, so the fast tick path,
+/// the level executor and the deferred observer phase stay enabled. Nodes ticked by a level
+/// executor are counted, but not timed, so they are never reported as the slowest node
+class turn_recorder
+{
+public:
+    virtual ~turn_recorder() = default;
+
+    /// Called after propagation of a turn is finished
+    virtual void on_turn_recorded( const turn_summary& summary ) = 0;
+
+    /// Called right before observer function is invoked. Admitted is turn_summary::admitted
+    /// of the running turn. Observers invoked by an observer executor are reported from its
+    /// threads, so the call can be concurrent with other calls of the method
+    virtual void on_observer_invoke( const reactive_node& /*node*/,
+        std::chrono::steady_clock::time_point /*admitted*/ )
+    {}
 };
 
 
@@ -554,120 +957,1184 @@ private:
 };
 
 
-class react_graph
+} // namespace detail
+
+
+/*! @brief Strategy that decides in which order scheduled nodes are ticked during a turn
+ *
+ *  During propagation react_graph pushes every node that should be ticked, then repeatedly
+ *  calls fetch_next() and ticks all nodes from next_values() in order. Scheduler should
+ *  ensure that a node is fetched only after all of its scheduled predecessors were ticked,
+ *  which is true for batches of nodes with the minimal level among pending ones.
+ *
+ *  Node levels can grow during a turn when dynamic nodes change their predecessors.
+ *  If a fetched node has new_level greater than level, react_graph doesn't tick it,
+ *  but updates its level and pushes it again with the new level, so the same node can be
+ *  pushed several times in a turn, possibly while its batch is being processed.
+ *  Batch returned by next_values() should stay unchanged until the next fetch_next().
+ */
+class scheduler
 {
 public:
-    react_graph() = default;
+    using value_type = detail::reactive_node*;
 
-    template <typename F>
-    void do_transaction( F&& func )
-    {
-        // Phase 1 - Input admission
-        ++m_transaction_level;
-        func();
-        --m_transaction_level;
+    virtual ~scheduler() = default;
 
-        if( m_transaction_level != 0 )
-        {
-            return;
-        }
+    /// Enqueue the node to be ticked on the given level in the current turn
+    virtual void push( value_type node, int level ) = 0;
 
-        // Phase 2 - apply_helper input node changes
-        bool should_propagate = false;
-        for( auto* p : m_changed_inputs )
-        {
-            if( p->apply_input() )
-            {
-                should_propagate = true;
-            }
-        }
-        m_changed_inputs.clear();
+    /// Select the next batch of nodes. Return false if there are no more pending nodes
+    virtual bool fetch_next() = 0;
 
-        // Phase 3 - propagate changes
-        if( should_propagate )
-        {
-            propagate();
-        }
+    /// Nodes of the batch selected by the last fetch_next()
+    virtual const std::vector<value_type>& next_values() const = 0;
 
-        detach_queued_observers();
-    }
+    /// Level of the batch selected by the last fetch_next()
+    virtual int next_level() const = 0;
+};
 
-    template <typename R, typename V>
-    void add_input( R& r, V&& v )
-    {
-        if( m_transaction_level > 0 )
-        {
-            add_transaction_input( r, std::forward<V>( v ) );
-        }
-        else
-        {
-            add_simple_input( r, std::forward<V>( v ) );
-        }
-    }
 
-    template <typename R, typename F>
-    void modify_input( R& r, const F& func )
-    {
-        if( m_transaction_level > 0 )
-        {
-            modify_transaction_input( r, func );
-        }
-        else
-        {
-            modify_simple_input( r, func );
-        }
-    }
+namespace detail
+{
 
-    void queue_observer_for_detach( observer_interface& obs )
+/*! @brief Interface of executors that tick nodes of a level concurrently
+ *
+ *  Before each level react_graph asks the executor whether it accepts the level.
+ *  If it doesn't, nodes are ticked serially as usual. Otherwise the graph updates levels
+ *  and passes ready nodes to tick_level(). Parallel safe nodes can be ticked on any thread
+ *  and the rest should be ticked on the calling thread.
+ *
+ *  While a node is ticked outside of the calling thread, its pulse is stored in the buffer
+ *  set by set_pulse_buffer() for that thread instead of being processed. Executor should
+ *  append all stored pulses to the pulsed vector and the graph processes them after return.
+ *
+ *  Nodes should be ticked with tick(), so tracepoints of the graph are emitted for them.
+ *
+ *  Levels are never offered to the executor while turn listeners exist.
+ */
+class level_executor
+{
+public:
+    virtual ~level_executor() = default;
+
+    /// Tick the node between tick_begin and tick_end tracepoints. Can be called on any thread
+    static void tick( reactive_node& node )
     {
-        m_detached_observers.push_back( &obs );
+        UREACT_PROBE2( tick_begin, get_node_id( node ), node.level );
+        node.tick();
+        UREACT_PROBE2( tick_end, get_node_id( node ), node.level );
     }
 
-    void propagate();
+    /// Return true to tick the level with tick_level()
+    virtual bool accepts_level( const std::vector<reactive_node*>& nodes ) = 0;
 
-    void on_node_attach( reactive_node& node, reactive_node& parent );
-    void on_node_detach( reactive_node& node, reactive_node& parent );
+    /// Tick all given nodes and append nodes that pulsed outside of the calling thread to pulsed
+    virtual void tick_level(
+        const std::vector<reactive_node*>& nodes, std::vector<reactive_node*>& pulsed )
+        = 0;
 
-    void on_input_change( reactive_node& node );
-    void on_node_pulse( reactive_node& node );
+    /// Redirect pulses of nodes ticked on the current thread to the buffer. nullptr to reset
+    static void set_pulse_buffer( std::vector<reactive_node*>* buffer )
+    {
+        pulse_buffer_ref() = buffer;
+    }
 
-    void on_dynamic_node_attach( reactive_node& node, reactive_node& parent );
-    void on_dynamic_node_detach( reactive_node& node, reactive_node& parent );
+    /// Buffer set for the current thread if any
+    static std::vector<reactive_node*>* pulse_buffer()
+    {
+        return pulse_buffer_ref();
+    }
 
 private:
-    class topological_queue
+    static std::vector<reactive_node*>*& pulse_buffer_ref()
     {
-    public:
-        using value_type = reactive_node*;
+        static thread_local std::vector<reactive_node*>* buffer = nullptr;
+        return buffer;
+    }
+};
 
-        topological_queue() = default;
 
-        void push( const value_type& value, const int level )
-        {
-            m_queue_data.emplace_back( value, level );
-        }
+class observer_node;
 
-        bool fetch_next();
+/*! @brief Interface of executors that invoke observers after propagation
+ *
+ *  Observers changed during a turn are collected instead of being invoked by propagation.
+ *  When propagation is finished, they are passed to invoke_observers() in the order of
+ *  their ticks. After it returns, observers that requested detaching are detached.
+ *
+ *  Observers are deferred only while there are no turn listeners. Critical observers
+ *  are never deferred.
+ */
+class observer_executor
+{
+public:
+    virtual ~observer_executor() = default;
+
+    /// Invoke all given observers and append those that requested detaching to detached
+    virtual void invoke_observers(
+        const std::vector<observer_node*>& observers, std::vector<observer_node*>& detached )
+        = 0;
+};
+
+
+/// Default scheduler that ticks nodes level by level.
+/// It is final, so the graph calls it without virtual dispatch
+class topological_queue final : public scheduler
+{
+public:
+    topological_queue() = default;
+
+    void push( const value_type node, const int level ) override
+    {
+        UREACT_ALLOC_SCOPE( scheduler_queue );
+        m_queue_data.emplace_back( node, level );
+    }
+
+    bool fetch_next() override;
+
+    const std::vector<value_type>& next_values() const override
+    {
+        return m_next_data;
+    }
+
+    int next_level() const override
+    {
+        return m_next_level;
+    }
+
+private:
+    using entry = std::pair<value_type, int>;
+
+    int m_next_level = 0;
+    std::vector<value_type> m_next_data;
+    std::vector<entry> m_queue_data;
+};
+
+
+/// Locks the mutex if it exists, i.e. if the context is not single threaded
+class optional_lock
+{
+public:
+    explicit optional_lock( std::recursive_mutex* mutex )
+        : m_mutex( mutex )
+    {
+        if( m_mutex )
+        {
+            m_mutex->lock();
+        }
+    }
+
+    optional_lock( const optional_lock& ) = delete;
+    optional_lock& operator=( const optional_lock& ) = delete;
+
+    ~optional_lock()
+    {
+        if( m_mutex )
+        {
+            m_mutex->unlock();
+        }
+    }
+
+private:
+    std::recursive_mutex* m_mutex;
+};
+
+
+/// State shared between the thread running a turn and threads submitting urgent transactions
+struct urgent_lane
+{
+    std::mutex mutex;
+    std::condition_variable applied_cv;
+
+    /// Set while a turn is running and urgent transactions can be merged into it
+    bool open = false;
+    std::thread::id owner;
+
+    std::vector<std::function<void()>> transactions;
+    std::uint64_t submitted = 0;
+    std::uint64_t applied = 0;
+
+    /// Exceptions thrown by applied transactions, rethrown to their submitters
+    std::vector<std::pair<std::uint64_t, std::exception_ptr>> failures;
+
+    /// Fast check for the turn thread at level boundaries
+    std::atomic<bool> pending{ false };
+};
+
+
+/// Nodes reachable from inputs admitted by transactions of a batch. See do_transactions.
+/// Reaches are marked on nodes with generations taken from graph_extras::batch_generation,
+/// so they are neither allocated nor merged. Nodes marked with generation are reached by the
+/// transaction being admitted, nodes marked in [group_start, generation) are reached by
+/// already applied transactions, that are not propagated yet
+struct transaction_batch
+{
+    std::uint64_t group_start = 0;
+    std::uint64_t generation = 0;
+
+    /// Inputs admitted by the transaction, to mark its reach again if other batches
+    /// overwrite the marks while this one is suspended
+    std::vector<reactive_node*> current_inputs;
+
+    std::vector<reactive_node*> stack;
+
+    bool should_propagate = false;
+
+    /// Set while a conflicting group is propagated in the middle of admission.
+    /// Inputs changed by observers then form their own turns as in serial transactions
+    bool suspended = false;
+};
+
+
+/// Recorders of a graph together with the summary of the running turn
+struct recording_state
+{
+    std::vector<turn_recorder*> recorders;
+    turn_summary summary;
+    std::chrono::steady_clock::time_point turn_start;
+
+    // Request time of the oldest input admitted since the last turn. Default if there is none
+    std::chrono::steady_clock::time_point oldest_admission;
+};
+
+
+/// Executors of a graph together with their scratch buffers
+struct executors_state
+{
+    level_executor* level = nullptr;
+
+    // Scratch buffers of tick_level_with_executor
+    std::vector<reactive_node*> ready_nodes;
+    std::vector<reactive_node*> pulsed_nodes;
+
+    observer_executor* observers = nullptr;
+
+    // Observers waiting for the observer phase of the turn and its scratch buffers
+    std::vector<observer_node*> deferred_observers;
+    std::vector<observer_node*> invoked_observers;
+    std::vector<observer_node*> detaching_observers;
+};
+
+
+/// Graph state that only some contexts need. It is allocated on first use,
+/// so graphs of single-threaded contexts without extensions stay small
+struct graph_extras
+{
+    std::unique_ptr<scheduler> custom_scheduler;
+
+    // Serializes input admission and propagation turns unless the context is single threaded
+    std::unique_ptr<std::recursive_mutex> mutex;
+
+    // Exists together with mutex
+    std::unique_ptr<urgent_lane> urgent;
+
+    // Allocated when the first executor is set
+    std::unique_ptr<executors_state> executors;
+
+    // Exists while there are turn recorders
+    std::unique_ptr<recording_state> recording;
+
+    // Batch of transactions being admitted if any
+    transaction_batch* batch = nullptr;
+
+    // Last generation used to mark reaches of transaction batches
+    std::uint64_t batch_generation = 0;
+
+    // Number of critical nodes. While there are any, other observers are deferred
+    std::size_t critical_nodes = 0;
+
+    // Number of inputs which values are deltas of turns. See add_delta_input
+    std::size_t delta_inputs = 0;
+
+    // Number of nodes that record admitted input values and those of them
+    // that should be ticked when admitted values are applied
+    std::size_t admission_recorders = 0;
+    std::vector<reactive_node*> admitted_recorders;
+};
+
+
+class react_graph
+{
+public:
+    react_graph() = default;
+
+    /// Use the given threading policy and scheduler.
+    /// Null scheduler means the default topological_queue
+    explicit react_graph(
+        const threading_policy policy, std::unique_ptr<scheduler> custom_scheduler = nullptr )
+        : m_threading_policy( policy )
+    {
+        if( custom_scheduler )
+        {
+            get_extras().custom_scheduler = std::move( custom_scheduler );
+        }
+
+        if( policy != threading_policy::single_threaded )
+        {
+            get_extras().mutex.reset( new std::recursive_mutex() );
+            get_extras().urgent.reset( new urgent_lane() );
+        }
+    }
+
+    threading_policy get_threading_policy() const
+    {
+        return m_threading_policy;
+    }
+
+    /// If func throws, inputs changed before the throw are applied anyway
+    /// and the exception is rethrown after the turn
+    template <typename F>
+    void do_transaction( F&& func )
+    {
+        // Inputs from other threads wait until the whole transaction is finished
+        const optional_lock lock( get_mutex() );
+
+        // Phase 1 - Input admission
+        std::exception_ptr error;
+        ++m_transaction_level;
+        try
+        {
+            func();
+        }
+        catch( ... )
+        {
+            error = std::current_exception();
+        }
+        --m_transaction_level;
+
+        if( m_transaction_level == 0 )
+        {
+            run_turn( [this] {
+                // Phase 2 - apply_helper input node changes
+                bool should_propagate = false;
+                for( auto* p : m_changed_inputs )
+                {
+                    if( p->apply_input() )
+                    {
+                        should_propagate = true;
+                    }
+                }
+                m_changed_inputs.clear();
+
+                // Phase 3 - propagate changes
+                if( should_propagate )
+                {
+                    propagate();
+                }
+            } );
+
+            detach_queued_observers();
+        }
+
+        if( error )
+        {
+            std::rethrow_exception( error );
+        }
+    }
+
+    /// Perform the transaction with the given priority.
+    /// If a turn is running on another thread, an urgent transaction is merged into it
+    /// at the next level boundary instead of waiting for the turn to finish. Then the call
+    /// returns after inputs are applied, and changes are propagated by the turn thread.
+    /// If func of a merged transaction throws, the exception is rethrown from this call,
+    /// while inputs changed before the throw are applied anyway.
+    /// While there are delta inputs, e.g. input collections, urgent transactions are merged
+    /// at the end of the running turn instead. See add_delta_input.
+    /// In single-threaded contexts all transactions are normal
+    template <typename F>
+    void do_transaction( const turn_priority priority, F&& func )
+    {
+        urgent_lane* const lane = get_urgent_lane();
+        if( priority == turn_priority::urgent && lane != nullptr )
+        {
+            std::unique_lock<std::mutex> lock( lane->mutex );
+            if( lane->open && lane->owner != std::this_thread::get_id() )
+            {
+                lane->transactions.emplace_back( std::forward<F>( func ) );
+                const std::uint64_t ticket = ++lane->submitted;
+                lane->pending.store( true, std::memory_order_release );
+                lane->applied_cv.wait( lock, [&] { return lane->applied >= ticket; } );
+
+                auto& failures = lane->failures;
+                for( auto it = failures.begin(); it != failures.end(); ++it )
+                {
+                    if( it->first == ticket )
+                    {
+                        const std::exception_ptr error = it->second;
+                        failures.erase( it );
+                        std::rethrow_exception( error );
+                    }
+                }
+                return;
+            }
+        }
+
+        do_transaction( std::forward<F>( func ) );
+    }
+
+    /// Perform transactions with the same observable result as performing them one by one.
+    /// Transactions whose reachable nodes don't overlap are propagated together in one turn,
+    /// so with parallel_executor their nodes are ticked concurrently. Before an input reaching
+    /// nodes of not yet propagated transactions is changed, they are propagated.
+    /// Transaction functions shouldn't read signals derived from inputs of other transactions
+    /// of the batch, because those could be not propagated yet
+    template <typename R>
+    void do_transactions( R&& transactions )
+    {
+        const optional_lock lock( get_mutex() );
+
+        if( m_transaction_level != 0 )
+        {
+            // All changes are applied together with the outer transaction anyway
+            for( auto&& func : transactions )
+            {
+                func();
+            }
+            return;
+        }
+
+        // Observer of a suspended batch can start its own one
+        graph_extras& extras = get_extras();
+        transaction_batch* const outer_batch = extras.batch;
+
+        transaction_batch batch;
+        batch.group_start = batch.generation = ++extras.batch_generation;
+        extras.batch = &batch;
+
+        // Transactions after the throwing one are not performed, as in a serial loop
+        std::exception_ptr error;
+        try
+        {
+            run_turn( [&] {
+                for( auto&& func : transactions )
+                {
+                    // Phase 1 - Input admission.
+                    // Conflicting groups are propagated from the input hooks
+                    ++m_transaction_level;
+                    try
+                    {
+                        func();
+                    }
+                    catch( ... )
+                    {
+                        error = std::current_exception();
+                    }
+                    --m_transaction_level;
+
+                    // Phase 2 - apply input changes, but postpone propagation
+                    for( auto* p : m_changed_inputs )
+                    {
+                        if( p->apply_input() )
+                        {
+                            batch.should_propagate = true;
+                        }
+                    }
+                    m_changed_inputs.clear();
+
+                    // Reach of the transaction joins the group
+                    batch.generation = ++extras.batch_generation;
+                    batch.current_inputs.clear();
+
+                    if( error )
+                    {
+                        break;
+                    }
+                }
+
+                extras.batch = outer_batch;
+
+                // Phase 3 - propagate changes of the last group
+                if( batch.should_propagate )
+                {
+                    propagate();
+                }
+            } );
+        }
+        catch( ... )
+        {
+            extras.batch = outer_batch;
+            throw;
+        }
+
+        detach_queued_observers();
+
+        if( error )
+        {
+            std::rethrow_exception( error );
+        }
+    }
+
+    template <typename R, typename V>
+    void add_input( R& r, V&& v )
+    {
+        const auto requested = request_time();
+
+        const optional_lock lock( get_mutex() );
+
+        transaction_batch* const batch = get_batch();
+        if( batch != nullptr && !batch->suspended )
+        {
+            admit_batch_input( *batch, r );
+        }
+
+        record_input_admission( requested );
+
+        if( m_transaction_level > 0 )
+        {
+            add_transaction_input( r, std::forward<V>( v ) );
+        }
+        else
+        {
+            add_simple_input( r, std::forward<V>( v ) );
+        }
+    }
+
+    template <typename R, typename F>
+    void modify_input( R& r, const F& func )
+    {
+        const auto requested = request_time();
+
+        const optional_lock lock( get_mutex() );
+
+        transaction_batch* const batch = get_batch();
+        if( batch != nullptr && !batch->suspended )
+        {
+            admit_batch_input( *batch, r );
+        }
+
+        record_input_admission( requested );
+
+        if( m_transaction_level > 0 )
+        {
+            modify_transaction_input( r, func );
+        }
+        else
+        {
+            modify_simple_input( r, func );
+        }
+    }
+
+    void queue_observer_for_detach( observer_interface& obs )
+    {
+        UREACT_ALLOC_SCOPE( scheduler_queue );
+        m_detached_observers.push_back( &obs );
+    }
+
+    void propagate();
+
+    // Graph changes aren't locked, because they happen inside of turns, e.g. by dynamic
+    // nodes, where the lock is already held. See threading_policy::thread_safe_inputs
+    void on_node_attach( reactive_node& node, reactive_node& parent );
+    void on_node_detach( reactive_node& node, reactive_node& parent );
+
+    void on_input_change( reactive_node& node );
+    void on_node_pulse( reactive_node& node );
+
+    /// Let successors of inputs see every admitted value, even if it is equal to the current one.
+    /// See reactive_node::on_predecessor_admitted
+    void add_admission_recorder()
+    {
+        ++get_extras().admission_recorders;
+    }
+
+    void remove_admission_recorder()
+    {
+        --m_extras->admission_recorders;
+    }
+
+    /// Register an input which value is the delta of the turn it changed in. Applying it again
+    /// in the middle of a turn would replace the delta before all successors read it, so while
+    /// there are any, urgent transactions are merged only at the end of turns
+    void add_delta_input()
+    {
+        ++get_extras().delta_inputs;
+    }
+
+    void remove_delta_input()
+    {
+        --m_extras->delta_inputs;
+    }
+
+    /// Called by input nodes after a new value is admitted
+    void on_input_admitted( reactive_node& node )
+    {
+        if( !m_extras || m_extras->admission_recorders == 0 )
+        {
+            return;
+        }
+
+        for( auto* succ : node.successors )
+        {
+            if( succ->on_predecessor_admitted( node ) )
+            {
+                UREACT_ALLOC_SCOPE( scheduler_queue );
+                m_extras->admitted_recorders.push_back( succ );
+            }
+        }
+    }
+
+    /// Called by input nodes when admitted values are applied.
+    /// Schedule recorders of admitted values. Return true if there were any
+    bool schedule_admitted_recorders()
+    {
+        if( !m_extras || m_extras->admitted_recorders.empty() )
+        {
+            return false;
+        }
+
+        for( auto* node : m_extras->admitted_recorders )
+        {
+            if( !node->queued )
+            {
+                node->queued = true;
+                schedule( *node );
+            }
+        }
+        m_extras->admitted_recorders.clear();
+        return true;
+    }
+
+    void set_critical( reactive_node& node )
+    {
+        if( !node.critical )
+        {
+            node.critical = true;
+            ++get_extras().critical_nodes;
+        }
+    }
+
+    /// Called by critical nodes on destruction
+    void unset_critical( reactive_node& node )
+    {
+        if( node.critical )
+        {
+            node.critical = false;
+            --m_extras->critical_nodes;
+        }
+    }
+
+    void on_observer_invoke( reactive_node& node, const reactive_node& subject )
+    {
+        UREACT_PROBE2( observer_invoke, get_node_id( node ), get_node_id( subject ) );
+        (void)subject;
+
+        if( const recording_state* recording = get_recording() )
+        {
+            for( auto* r : recording->recorders )
+            {
+                r->on_observer_invoke( node, recording->summary.admitted );
+            }
+        }
+
+        for( auto* l : m_turn_listeners )
+        {
+            l->on_observer_invoke( node );
+        }
+    }
+
+    void on_dynamic_node_attach( reactive_node& node, reactive_node& parent );
+    void on_dynamic_node_detach( reactive_node& node, reactive_node& parent );
+
+    void add_turn_listener( turn_listener& listener )
+    {
+        m_turn_listeners.push_back( &listener );
+    }
+
+    void remove_turn_listener( turn_listener& listener )
+    {
+        const auto it = ureact::detail::find(
+            m_turn_listeners.begin(), m_turn_listeners.end(), &listener );
+        if( it != m_turn_listeners.end() )
+        {
+            m_turn_listeners.erase( it );
+        }
+    }
+
+    void add_turn_recorder( turn_recorder& recorder )
+    {
+        graph_extras& extras = get_extras();
+        if( !extras.recording )
+        {
+            extras.recording.reset( new recording_state() );
+        }
+        extras.recording->recorders.push_back( &recorder );
+        update_admission_stamps();
+    }
+
+    /// Ticks are timed only while there are recorders, so state is freed with the last one
+    void remove_turn_recorder( turn_recorder& recorder )
+    {
+        recording_state* recording = get_recording();
+        if( recording == nullptr )
+        {
+            return;
+        }
+
+        std::vector<turn_recorder*>& recorders = recording->recorders;
+        const auto it = ureact::detail::find( recorders.begin(), recorders.end(), &recorder );
+        if( it != recorders.end() )
+        {
+            recorders.erase( it );
+        }
+        if( recorders.empty() )
+        {
+            m_extras->recording.reset();
+        }
+        update_admission_stamps();
+    }
+
+    /// Set executor used to tick levels concurrently. nullptr to tick all levels serially.
+    /// Requires threading_policy::thread_safe_inputs
+    void set_level_executor( level_executor* executor )
+    {
+        assert( executor == nullptr
+                || m_threading_policy == threading_policy::thread_safe_inputs );
+        get_executors().level = executor;
+    }
+
+    /// Set executor used to invoke observers after propagation. nullptr to invoke observers
+    /// during propagation. Requires threading_policy::thread_safe_inputs
+    void set_observer_executor( observer_executor* executor )
+    {
+        assert( executor == nullptr
+                || m_threading_policy == threading_policy::thread_safe_inputs );
+        get_executors().observers = executor;
+    }
+
+    /// Postpone invocation of the observer until the observer phase of the turn.
+    /// Return false if the observer should be invoked immediately
+    bool defer_observer( observer_node& node );
+
+    /// Return id of the current turn or of the last finished one
+    turn_id_t current_turn() const
+    {
+        return m_turn_id;
+    }
+
+    /// Return true if urgent transactions wait to be merged into the running turn
+    bool has_pending_urgent_transactions() const
+    {
+        const urgent_lane* lane = get_urgent_lane();
+        return lane != nullptr && lane->pending.load( std::memory_order_acquire );
+    }
+
+private:
+    void update_admission_stamps()
+    {
+        m_stamps_admissions.store( get_recording() != nullptr, std::memory_order_relaxed );
+    }
+
+    // Time an input is requested, taken before waiting for the graph lock, so recorders
+    // can include queueing time. They can be attached while other threads set inputs,
+    // so only the atomic flag is read before locking
+    std::chrono::steady_clock::time_point request_time() const
+    {
+        return m_stamps_admissions.load( std::memory_order_relaxed )
+                 ? std::chrono::steady_clock::now()
+                 : std::chrono::steady_clock::time_point{};
+    }
+
+    void record_input_admission( std::chrono::steady_clock::time_point requested )
+    {
+        recording_state* recording = get_recording();
+        if( recording == nullptr )
+        {
+            return;
+        }
+
+        // Recorder was attached after the input was requested
+        if( requested == std::chrono::steady_clock::time_point{} )
+        {
+            requested = std::chrono::steady_clock::now();
+        }
+
+        if( recording->oldest_admission == std::chrono::steady_clock::time_point{}
+            || requested < recording->oldest_admission )
+        {
+            recording->oldest_admission = requested;
+        }
+    }
+
+    void detach_queued_observers()
+    {
+        for( auto* o : m_detached_observers )
+        {
+            o->unregister_self();
+        }
+        m_detached_observers.clear();
+    }
+
+    // Turns can be nested if observer changes some input during propagation.
+    // Only the outermost one is reported to listeners
+    void begin_turn()
+    {
+        if( m_turn_depth++ == 0 )
+        {
+            ++m_turn_id;
+
+            if( urgent_lane* lane = get_urgent_lane() )
+            {
+                std::lock_guard<std::mutex> lock( lane->mutex );
+                lane->open = true;
+                lane->owner = std::this_thread::get_id();
+            }
+
+            UREACT_PROBE1( turn_begin, m_turn_id );
+
+            if( recording_state* recording = get_recording() )
+            {
+                recording->summary = turn_summary{};
+                recording->summary.turn_id = m_turn_id;
+                recording->turn_start = std::chrono::steady_clock::now();
+                recording->summary.admitted
+                    = recording->oldest_admission != std::chrono::steady_clock::time_point{}
+                        ? recording->oldest_admission
+                        : recording->turn_start;
+                recording->oldest_admission = std::chrono::steady_clock::time_point{};
+            }
+
+            for( auto* l : m_turn_listeners )
+            {
+                l->on_turn_begin( m_turn_id );
+            }
+        }
+    }
+
+    void end_turn()
+    {
+        if( m_turn_depth == 1 && can_merge_urgent_transactions() )
+        {
+            // Urgent transactions submitted after the last level boundary
+            while( merge_urgent_transactions( true ) )
+            {
+                propagate();
+            }
+        }
+
+        // Observers can start nested turns deferring more observers
+        executors_state* executors = m_extras ? m_extras->executors.get() : nullptr;
+        while( m_turn_depth == 1 && executors && !executors->deferred_observers.empty() )
+        {
+            invoke_deferred_observers();
+        }
+
+        if( m_turn_depth == 1 )
+        {
+            finish_turn();
+        }
+        --m_turn_depth;
+    }
+
+    // Run the turn body between begin_turn() and end_turn(). If the turn is left
+    // by an exception, the graph is restored with abort_turn() and the exception is rethrown
+    template <typename F>
+    void run_turn( const F& body )
+    {
+        begin_turn();
+        try
+        {
+            body();
+            end_turn();
+        }
+        catch( ... )
+        {
+            abort_turn( std::current_exception() );
+            throw;
+        }
+    }
 
-        const std::vector<value_type>& next_values() const
+    // Nodes left queued by the throwing propagation are already unmarked by propagate().
+    // Urgent transactions not merged yet fail with the same exception,
+    // so their submitters don't wait for the turn forever
+    void abort_turn( const std::exception_ptr& error )
+    {
+        m_changed_inputs.clear();
+
+        if( m_turn_depth == 1 )
         {
-            return m_next_data;
+            if( m_extras )
+            {
+                m_extras->admitted_recorders.clear();
+
+                if( executors_state* executors = m_extras->executors.get() )
+                {
+                    executors->deferred_observers.clear();
+                    executors->invoked_observers.clear();
+                    executors->detaching_observers.clear();
+                }
+            }
+
+            if( urgent_lane* lane = get_urgent_lane() )
+            {
+                {
+                    std::lock_guard<std::mutex> lock( lane->mutex );
+                    for( std::uint64_t ticket = lane->applied + 1; ticket <= lane->submitted;
+                         ++ticket )
+                    {
+                        lane->failures.emplace_back( ticket, error );
+                    }
+                    lane->transactions.clear();
+                    lane->applied = lane->submitted;
+                    lane->open = false;
+                    lane->pending.store( false, std::memory_order_relaxed );
+                }
+                lane->applied_cv.notify_all();
+            }
+
+            finish_turn();
         }
+        --m_turn_depth;
 
-    private:
-        using entry = std::pair<value_type, int>;
+        detach_queued_observers();
+    }
 
-        std::vector<value_type> m_next_data;
-        std::vector<entry> m_queue_data;
-    };
+    // Report the end of the outermost turn
+    void finish_turn()
+    {
+        for( auto* l : m_turn_listeners )
+        {
+            l->on_turn_end( m_turn_id );
+        }
 
-    void detach_queued_observers()
+        if( recording_state* recording = get_recording() )
+        {
+            recording->summary.duration_ns
+                = elapsed_ns( recording->turn_start, std::chrono::steady_clock::now() );
+            for( auto* r : recording->recorders )
+            {
+                r->on_turn_recorded( recording->summary );
+            }
+
+            // Inputs admitted inside of the turn were applied by it
+            recording->oldest_admission = std::chrono::steady_clock::time_point{};
+        }
+
+        UREACT_PROBE1( turn_end, m_turn_id );
+    }
+
+    void tick_node( reactive_node& node );
+
+    void tick_node_with_hooks( reactive_node& node );
+
+    static std::uint64_t elapsed_ns( const std::chrono::steady_clock::time_point& from,
+        const std::chrono::steady_clock::time_point& to )
     {
-        for( auto* o : m_detached_observers )
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( to - from ).count() );
+    }
+
+    // Inputs of a batch being admitted would be applied together with urgent ones,
+    // so they are merged only after admission is finished
+    bool can_merge_urgent_transactions() const
+    {
+        return get_urgent_lane() != nullptr && m_extras->batch == nullptr;
+    }
+
+    // Merging at a level boundary applies inputs again in the middle of a turn
+    bool can_merge_urgent_transactions_in_turn() const
+    {
+        return can_merge_urgent_transactions() && m_extras->delta_inputs == 0;
+    }
+
+    // Apply inputs of submitted urgent transactions in the running turn.
+    // Return false if there were none. Closes the lane in that case if requested
+    bool merge_urgent_transactions( const bool close_if_empty )
+    {
+        urgent_lane& lane = *m_extras->urgent;
+
+        std::vector<std::function<void()>> transactions;
+        std::uint64_t ticket = 0;
         {
-            o->unregister_self();
+            std::lock_guard<std::mutex> lock( lane.mutex );
+            lane.pending.store( false, std::memory_order_relaxed );
+            if( lane.transactions.empty() )
+            {
+                if( close_if_empty )
+                {
+                    lane.open = false;
+                }
+                return false;
+            }
+            transactions.swap( lane.transactions );
+            ticket = lane.submitted;
         }
-        m_detached_observers.clear();
+
+        // Failed transaction is reported to its submitter, the others are still applied
+        std::vector<std::pair<std::uint64_t, std::exception_ptr>> failures;
+        std::uint64_t func_ticket = ticket - transactions.size();
+
+        ++m_transaction_level;
+        for( const auto& func : transactions )
+        {
+            ++func_ticket;
+            try
+            {
+                func();
+            }
+            catch( ... )
+            {
+                failures.emplace_back( func_ticket, std::current_exception() );
+            }
+        }
+        --m_transaction_level;
+
+        for( auto* p : m_changed_inputs )
+        {
+            p->apply_input();
+        }
+        m_changed_inputs.clear();
+
+        {
+            std::lock_guard<std::mutex> lock( lane.mutex );
+            lane.applied = ticket;
+            lane.failures.insert(
+                lane.failures.end(), failures.begin(), failures.end() );
+        }
+        lane.applied_cv.notify_all();
+
+        return true;
+    }
+
+    template <typename scheduler_t>
+    void tick_batch_node( scheduler_t& scheduled_nodes, reactive_node* node );
+
+    // Mark reach of the input with the generation of the current transaction of the batch.
+    // Return true if it overlaps the reach of the group. Nodes already reached by the
+    // transaction are not walked again
+    static bool mark_batch_reach( transaction_batch& batch, reactive_node& input )
+    {
+        bool conflict = false;
+        batch.stack.push_back( &input );
+        while( !batch.stack.empty() )
+        {
+            reactive_node* const node = batch.stack.back();
+            batch.stack.pop_back();
+
+            if( node->batch_mark == batch.generation )
+            {
+                continue;
+            }
+
+            if( node->batch_mark >= batch.group_start )
+            {
+                conflict = true;
+            }
+
+            node->batch_mark = batch.generation;
+            batch.stack.insert(
+                batch.stack.end(), node->successors.begin(), node->successors.end() );
+        }
+        return conflict;
+    }
+
+    // Add reach of the input to the current transaction of the batch.
+    // Propagate the group of previous transactions first if their reaches overlap
+    void admit_batch_input( transaction_batch& batch, reactive_node& input )
+    {
+        batch.current_inputs.push_back( &input );
+
+        if( mark_batch_reach( batch, input ) )
+        {
+            // The group is propagated outside of the transaction being admitted,
+            // so inputs changed by its observers aren't merged into the transaction
+            const int transaction_level = m_transaction_level;
+            m_transaction_level = 0;
+            batch.suspended = true;
+
+            try
+            {
+                if( batch.should_propagate )
+                {
+                    propagate();
+                }
+
+                end_turn();
+                detach_queued_observers();
+                begin_turn();
+            }
+            catch( ... )
+            {
+                // The turn is still running, so it is restored by the caller of do_transactions
+                batch.suspended = false;
+                m_transaction_level = transaction_level;
+                throw;
+            }
+
+            batch.suspended = false;
+            m_transaction_level = transaction_level;
+
+            graph_extras& extras = get_extras();
+            if( extras.batch_generation == batch.generation )
+            {
+                // Marks of the transaction are intact, the group is just emptied
+                batch.group_start = batch.generation;
+            }
+            else
+            {
+                // Observers ran other batches that overwrote the marks
+                batch.group_start = batch.generation = ++extras.batch_generation;
+                for( reactive_node* p : batch.current_inputs )
+                {
+                    mark_batch_reach( batch, *p );
+                }
+            }
+
+            batch.should_propagate = false;
+        }
+    }
+
+    template <typename scheduler_t>
+    void tick_level_with_executor( scheduler_t& scheduled_nodes );
+
+    void invoke_deferred_observers();
+
+    graph_extras& get_extras()
+    {
+        if( !m_extras )
+        {
+            m_extras.reset( new graph_extras() );
+        }
+        return *m_extras;
+    }
+
+    executors_state& get_executors()
+    {
+        graph_extras& extras = get_extras();
+        if( !extras.executors )
+        {
+            extras.executors.reset( new executors_state() );
+        }
+        return *extras.executors;
+    }
+
+    level_executor* get_level_executor() const
+    {
+        return m_extras && m_extras->executors ? m_extras->executors->level : nullptr;
+    }
+
+    std::recursive_mutex* get_mutex() const
+    {
+        return m_extras ? m_extras->mutex.get() : nullptr;
+    }
+
+    urgent_lane* get_urgent_lane() const
+    {
+        return m_extras ? m_extras->urgent.get() : nullptr;
+    }
+
+    recording_state* get_recording() const
+    {
+        return m_extras ? m_extras->recording.get() : nullptr;
+    }
+
+    transaction_batch* get_batch() const
+    {
+        return m_extras ? m_extras->batch : nullptr;
+    }
+
+    scheduler* get_custom_scheduler() const
+    {
+        return m_extras ? m_extras->custom_scheduler.get() : nullptr;
     }
 
     // Create a turn with a single input
@@ -676,10 +2143,12 @@ private:
     {
         r.add_input( std::forward<V>( v ) );
 
-        if( r.apply_input() )
-        {
-            propagate();
-        }
+        run_turn( [&] {
+            if( r.apply_input() )
+            {
+                propagate();
+            }
+        } );
 
         detach_queued_observers();
     }
@@ -689,10 +2158,12 @@ private:
     {
         r.modify_input( func );
 
-        if( r.apply_input() )
-        {
-            propagate();
-        }
+        run_turn( [&] {
+            if( r.apply_input() )
+            {
+                propagate();
+            }
+        } );
 
         detach_queued_observers();
     }
@@ -703,6 +2174,7 @@ private:
     {
         r.add_input( std::forward<V>( v ) );
 
+        UREACT_ALLOC_SCOPE( scheduler_queue );
         m_changed_inputs.push_back( &r );
     }
 
@@ -711,6 +2183,7 @@ private:
     {
         r.modify_input( func );
 
+        UREACT_ALLOC_SCOPE( scheduler_queue );
         m_changed_inputs.push_back( &r );
     }
 
@@ -718,17 +2191,45 @@ private:
 
     void process_children( reactive_node& node );
 
+    void schedule( reactive_node& node )
+    {
+        if( scheduler* custom_scheduler = get_custom_scheduler() )
+        {
+            custom_scheduler->push( &node, node.level );
+        }
+        else
+        {
+            m_scheduled_nodes.push( &node, node.level );
+        }
+    }
+
+    template <typename scheduler_t>
+    void propagate( scheduler_t& scheduled_nodes );
+
     topological_queue m_scheduled_nodes;
 
+    std::unique_ptr<graph_extras> m_extras;
+
+    threading_policy m_threading_policy = threading_policy::single_threaded;
+
     int m_transaction_level = 0;
 
     std::vector<input_node_interface*> m_changed_inputs;
 
     std::vector<observer_interface*> m_detached_observers;
+
+    std::vector<turn_listener*> m_turn_listeners;
+
+    turn_id_t m_turn_id = 0;
+
+    int m_turn_depth = 0;
+
+    // Set while there are turn recorders, read without the graph lock
+    std::atomic<bool> m_stamps_admissions{ false };
 };
 
 
-inline bool react_graph::topological_queue::fetch_next()
+inline bool topological_queue::fetch_next()
 {
     // Throw away previous values
     m_next_data.clear();
@@ -743,73 +2244,266 @@ inline bool react_graph::topological_queue::fetch_next()
         }
     }
 
+    m_next_level = minimal_level;
+
     // Swap entries with min level to the end
     const auto p = ureact::detail::partition( m_queue_data.begin(),
         m_queue_data.end(),
         [minimal_level]( const entry& e ) { return e.second != minimal_level; } );
 
+    UREACT_ALLOC_SCOPE( scheduler_queue );
+
     // Reserve once to avoid multiple re-allocations
     const auto to_reserve = static_cast<size_t>( std::distance( p, m_queue_data.end() ) );
     m_next_data.reserve( to_reserve );
 
-    // Move min level values to next data
-    for( auto it = p, ite = m_queue_data.end(); it != ite; ++it )
+    // Move min level values to next data
+    for( auto it = p, ite = m_queue_data.end(); it != ite; ++it )
+    {
+        m_next_data.push_back( it->first );
+    }
+
+    // Truncate moved entries
+    const auto to_resize = static_cast<size_t>( std::distance( m_queue_data.begin(), p ) );
+    m_queue_data.resize( to_resize );
+
+    return !m_next_data.empty();
+}
+
+inline void react_graph::on_node_attach( reactive_node& node, reactive_node& parent )
+{
+    UREACT_ALLOC_SCOPE( successors );
+
+    parent.successors.push_back( &node );
+
+    if( node.level <= parent.level )
+    {
+        node.level = parent.level + 1;
+    }
+}
+
+inline void react_graph::on_node_detach( reactive_node& node, reactive_node& parent )
+{
+    const auto it
+        = ureact::detail::find( parent.successors.begin(), parent.successors.end(), &node );
+    parent.successors.erase( it );
+}
+
+inline void react_graph::on_input_change( reactive_node& node )
+{
+    UREACT_PROBE1( input_applied, get_node_id( node ) );
+
+    if( recording_state* recording = get_recording() )
+    {
+        ++recording->summary.inputs_applied;
+    }
+
+    for( auto* l : m_turn_listeners )
+    {
+        l->on_input_applied( node );
+    }
+
+    process_children( node );
+}
+
+inline void react_graph::on_node_pulse( reactive_node& node )
+{
+    if( get_level_executor() != nullptr )
+    {
+        if( auto* buffer = level_executor::pulse_buffer() )
+        {
+            buffer->push_back( &node );
+            return;
+        }
+    }
+
+    for( auto* l : m_turn_listeners )
+    {
+        l->on_node_pulse( node );
+    }
+
+    process_children( node );
+}
+
+inline void react_graph::propagate()
+{
+    if( scheduler* custom_scheduler = get_custom_scheduler() )
+    {
+        propagate( *custom_scheduler );
+    }
+    else
+    {
+        propagate( m_scheduled_nodes );
+    }
+}
+
+template <typename scheduler_t>
+void react_graph::propagate( scheduler_t& scheduled_nodes )
+{
+    // Number of nodes of the current level that are already unmarked
+    std::size_t visited = 0;
+    try
+    {
+        for( ;; )
+        {
+            // Level boundary
+            if( can_merge_urgent_transactions_in_turn()
+                && m_extras->urgent->pending.load( std::memory_order_acquire ) )
+            {
+                merge_urgent_transactions( false );
+            }
+
+            visited = 0;
+            if( !scheduled_nodes.fetch_next() )
+            {
+                break;
+            }
+
+            UREACT_PROBE2(
+                level_begin, scheduled_nodes.next_level(), scheduled_nodes.next_values().size() );
+
+            // Nested turns started by observers ticked by the executor are ticked serially,
+            // because the executor and its scratch buffers are busy with the outer level
+            level_executor* executor = get_level_executor();
+            if( executor != nullptr && m_turn_depth == 1 && m_turn_listeners.empty()
+                && executor->accepts_level( scheduled_nodes.next_values() ) )
+            {
+                visited = scheduled_nodes.next_values().size();
+                tick_level_with_executor( scheduled_nodes );
+            }
+            else
+            {
+                for( auto* cur_node : scheduled_nodes.next_values() )
+                {
+                    ++visited;
+                    tick_batch_node( scheduled_nodes, cur_node );
+                }
+            }
+
+            UREACT_PROBE1( level_end, scheduled_nodes.next_level() );
+        }
+    }
+    catch( ... )
+    {
+        // Rest of the turn is dropped. Unmarked nodes can be scheduled by the next turns
+        const auto& nodes = scheduled_nodes.next_values();
+        for( std::size_t i = visited; i < nodes.size(); ++i )
+        {
+            nodes[i]->queued = false;
+        }
+        while( scheduled_nodes.fetch_next() )
+        {
+            for( auto* node : scheduled_nodes.next_values() )
+            {
+                node->queued = false;
+            }
+        }
+        throw;
+    }
+}
+
+template <typename scheduler_t>
+void react_graph::tick_batch_node( scheduler_t& scheduled_nodes, reactive_node* node )
+{
+    if( node->level < node->new_level )
+    {
+        node->level = node->new_level;
+        invalidate_successors( *node );
+        scheduled_nodes.push( node, node->level );
+        return;
+    }
+
+    node->queued = false;
+    tick_node( *node );
+}
+
+template <typename scheduler_t>
+void react_graph::tick_level_with_executor( scheduler_t& scheduled_nodes )
+{
+    executors_state& executors = *m_extras->executors;
+
+    executors.ready_nodes.clear();
+    for( auto* cur_node : scheduled_nodes.next_values() )
+    {
+        if( cur_node->level < cur_node->new_level )
+        {
+            cur_node->level = cur_node->new_level;
+            invalidate_successors( *cur_node );
+            scheduled_nodes.push( cur_node, cur_node->level );
+            continue;
+        }
+
+        cur_node->queued = false;
+        executors.ready_nodes.push_back( cur_node );
+    }
+
+    if( recording_state* recording = get_recording() )
     {
-        m_next_data.push_back( it->first );
+        recording->summary.nodes_ticked
+            += static_cast<std::uint32_t>( executors.ready_nodes.size() );
     }
 
-    // Truncate moved entries
-    const auto to_resize = static_cast<size_t>( std::distance( m_queue_data.begin(), p ) );
-    m_queue_data.resize( to_resize );
+    executors.pulsed_nodes.clear();
+    executors.level->tick_level( executors.ready_nodes, executors.pulsed_nodes );
 
-    return !m_next_data.empty();
+    // Turn listeners are absent, so only successors should be processed
+    for( auto* pulsed : executors.pulsed_nodes )
+    {
+        process_children( *pulsed );
+    }
 }
 
-inline void react_graph::on_node_attach( reactive_node& node, reactive_node& parent )
+inline void react_graph::tick_node( reactive_node& node )
 {
-    parent.successors.push_back( &node );
+    UREACT_PROBE2( tick_begin, get_node_id( node ), node.level );
 
-    if( node.level <= parent.level )
+    if( m_turn_listeners.empty() && get_recording() == nullptr )
     {
-        node.level = parent.level + 1;
+        node.tick();
+    }
+    else
+    {
+        tick_node_with_hooks( node );
     }
-}
-
-inline void react_graph::on_node_detach( reactive_node& node, reactive_node& parent )
-{
-    const auto it
-        = ureact::detail::find( parent.successors.begin(), parent.successors.end(), &node );
-    parent.successors.erase( it );
-}
 
-inline void react_graph::on_input_change( reactive_node& node )
-{
-    process_children( node );
+    UREACT_PROBE2( tick_end, get_node_id( node ), node.level );
 }
 
-inline void react_graph::on_node_pulse( reactive_node& node )
+inline void react_graph::tick_node_with_hooks( reactive_node& node )
 {
-    process_children( node );
-}
+    for( auto* l : m_turn_listeners )
+    {
+        l->on_tick_begin( node );
+    }
 
-inline void react_graph::propagate()
-{
-    while( m_scheduled_nodes.fetch_next() )
+    if( get_recording() != nullptr )
     {
-        for( auto* cur_node : m_scheduled_nodes.next_values() )
+        const auto start = std::chrono::steady_clock::now();
+        node.tick();
+        const std::uint64_t duration = elapsed_ns( start, std::chrono::steady_clock::now() );
+
+        // Recorder could be reset by the node, e.g. by an observer
+        if( recording_state* recording = get_recording() )
         {
-            if( cur_node->level < cur_node->new_level )
+            turn_summary& summary = recording->summary;
+            ++summary.nodes_ticked;
+            // Node is identified by id, because it can be destroyed before the turn ends
+            if( summary.slowest_node == 0 || duration > summary.slowest_node_ns )
             {
-                cur_node->level = cur_node->new_level;
-                invalidate_successors( *cur_node );
-                m_scheduled_nodes.push( cur_node, cur_node->level );
-                continue;
+                summary.slowest_node = get_node_id( node );
+                summary.slowest_node_ns = duration;
             }
-
-            cur_node->queued = false;
-            cur_node->tick();
         }
     }
+    else
+    {
+        node.tick();
+    }
+
+    for( auto* l : m_turn_listeners )
+    {
+        l->on_tick_end( node );
+    }
 }
 
 inline void react_graph::on_dynamic_node_attach( reactive_node& node, reactive_node& parent )
@@ -820,7 +2514,7 @@ inline void react_graph::on_dynamic_node_attach( reactive_node& node, reactive_n
 
     // Re-schedule this node
     node.queued = true;
-    m_scheduled_nodes.push( &node, node.level );
+    schedule( node );
 }
 
 inline void react_graph::on_dynamic_node_detach( reactive_node& node, reactive_node& parent )
@@ -833,10 +2527,15 @@ inline void react_graph::process_children( reactive_node& node )
     // add children to queue
     for( auto* succ : node.successors )
     {
+        if( succ->tracks_changed_predecessors )
+        {
+            succ->on_predecessor_changed( node );
+        }
+
         if( !succ->queued )
         {
             succ->queued = true;
-            m_scheduled_nodes.push( succ, succ->level );
+            schedule( *succ );
         }
     }
 }
@@ -859,6 +2558,11 @@ public:
         : m_graph( new react_graph() )
     {}
 
+    explicit context_internals(
+        const threading_policy policy, std::unique_ptr<scheduler> custom_scheduler = nullptr )
+        : m_graph( new react_graph( policy, std::move( custom_scheduler ) ) )
+    {}
+
     react_graph& get_graph()
     {
         return *m_graph;
@@ -926,9 +2630,73 @@ public:
     explicit observer_node( context& context )
         : node_base( context )
     {}
+
+    ~observer_node() override
+    {
+        get_graph().unset_critical( *this );
+    }
+
+    /// Call the observer function. Return true if the observer should be detached
+    virtual bool invoke() = 0;
+
+    /// Node the observer is attached to. nullptr if it is already detached
+    virtual const reactive_node* subject() const = 0;
 };
 
 
+// Non-critical observers are deferred while critical ones exist, so the critical ones
+// are invoked first even if they are at higher levels
+inline bool react_graph::defer_observer( observer_node& node )
+{
+    if( node.critical )
+    {
+        return false;
+    }
+
+    const executors_state* executors = m_extras ? m_extras->executors.get() : nullptr;
+    const bool has_executor
+        = executors != nullptr && executors->observers != nullptr && m_turn_listeners.empty();
+    if( !has_executor && ( !m_extras || m_extras->critical_nodes == 0 ) )
+    {
+        return false;
+    }
+
+    UREACT_ALLOC_SCOPE( scheduler_queue );
+    get_executors().deferred_observers.push_back( &node );
+    return true;
+}
+
+inline void react_graph::invoke_deferred_observers()
+{
+    executors_state& executors = *m_extras->executors;
+
+    executors.invoked_observers.swap( executors.deferred_observers );
+
+    executors.detaching_observers.clear();
+    if( executors.observers != nullptr && m_turn_listeners.empty() )
+    {
+        executors.observers->invoke_observers(
+            executors.invoked_observers, executors.detaching_observers );
+    }
+    else
+    {
+        for( auto* node : executors.invoked_observers )
+        {
+            if( node->invoke() )
+            {
+                executors.detaching_observers.push_back( node );
+            }
+        }
+    }
+    executors.invoked_observers.clear();
+
+    for( auto* node : executors.detaching_observers )
+    {
+        queue_observer_for_detach( *node );
+    }
+}
+
+
 class observable_node
     : public node_base
     , public observable
@@ -1007,13 +2775,18 @@ public:
     template <typename V>
     void add_input( V&& new_value )
     {
-        m_new_value = std::forward<V>( new_value );
+        {
+            UREACT_ALLOC_SCOPE( value_copy );
+            m_new_value = std::forward<V>( new_value );
+        }
 
         m_is_input_added = true;
 
         // m_is_input_added takes precedences over m_is_input_modified
         // the only difference between the two is that m_is_input_modified doesn't/can't compare
         m_is_input_modified = false;
+
+        var_node::get_graph().on_input_admitted( *this );
     }
 
     // This is signal-specific
@@ -1034,32 +2807,47 @@ public:
         {
             func( m_new_value );
         }
+
+        var_node::get_graph().on_input_admitted( *this );
     }
 
     bool apply_input() override
     {
+        react_graph& graph = var_node::get_graph();
+
         if( m_is_input_added )
         {
             m_is_input_added = false;
 
             if( !equals( this->m_value, m_new_value ) )
             {
-                this->m_value = std::move( m_new_value );
-                var_node::get_graph().on_input_change( *this );
+                {
+                    UREACT_ALLOC_SCOPE( value_copy );
+                    this->m_value = std::move( m_new_value );
+                }
+                graph.on_input_change( *this );
+                graph.schedule_admitted_recorders();
                 return true;
             }
-            return false;
+            return graph.schedule_admitted_recorders();
         }
         if( m_is_input_modified )
         {
             m_is_input_modified = false;
 
-            var_node::get_graph().on_input_change( *this );
+            graph.on_input_change( *this );
+            graph.schedule_admitted_recorders();
             return true;
         }
         return false;
     }
 
+    /// Value the node has after the admitted input is applied
+    const S& admitted_value() const
+    {
+        return m_is_input_added ? m_new_value : this->m_value;
+    }
+
 private:
     S m_new_value;
     bool m_is_input_added = false;
@@ -1073,6 +2861,9 @@ class function_op
 public:
     using dep_holder_t = std::tuple<deps_t...>;
 
+    using parallel_safe = std::integral_constant<bool,
+        is_parallel_safe_function<F>::value && are_parallel_safe_dependencies<deps_t...>::value>;
+
     template <typename in_f, typename... deps_in_t>
     explicit function_op( in_f&& func, deps_in_t&&... deps )
         : m_deps( std::forward<deps_in_t>( deps )... )
@@ -1096,6 +2887,10 @@ public:
         return apply( eval_functor( m_func ), m_deps );
     }
 
+    // fold_op takes operands of a binary op when the third operand is appended
+    template <typename, typename>
+    friend class fold_op;
+
     template <typename node_t>
     void attach( node_t& node ) const
     {
@@ -1209,6 +3004,95 @@ private:
 };
 
 
+/// Left fold of a binary function over three or more signals of type S.
+/// Operator chains like a + b + c + ... over signals of the same type are fused into
+/// a single fold_op instead of nested function_op types, so the type of an expression
+/// and the number of instantiated templates don't grow with the number of terms.
+/// Two operands are kept in function_op, so a single a + b doesn't allocate operand storage
+template <typename S, typename F>
+class fold_op
+{
+public:
+    using binary_op_t = function_op<S, F, signal_node_ptr_t<S>, signal_node_ptr_t<S>>;
+
+    using parallel_safe = is_parallel_safe_function<F>;
+
+    /// Take operands of the binary op and add the third one
+    fold_op( binary_op_t&& op, signal_node_ptr_t<S> dep )
+        : m_deps{ std::move( std::get<0>( op.m_deps ) ),
+            std::move( std::get<1>( op.m_deps ) ),
+            std::move( dep ) }
+        , m_func( std::move( op.m_func ) )
+    {}
+
+    fold_op( fold_op&& other ) noexcept
+        : m_deps( std::move( other.m_deps ) )
+        , m_func( std::move( other.m_func ) )
+    {}
+
+    fold_op& operator=( fold_op&& ) noexcept = delete;
+
+    fold_op( const fold_op& ) = delete;
+    fold_op& operator=( const fold_op& ) = delete;
+
+    ~fold_op() = default;
+
+    /// Add the next right operand
+    void append( signal_node_ptr_t<S> dep )
+    {
+        m_deps.push_back( std::move( dep ) );
+    }
+
+    S evaluate()
+    {
+        assert( m_deps.size() >= 3 );
+        return evaluate_to( m_deps.size() - 1 );
+    }
+
+    template <typename node_t>
+    void attach( node_t& node ) const
+    {
+        for( const auto& dep : m_deps )
+        {
+            node.get_graph().on_node_attach( node, *dep );
+        }
+    }
+
+    template <typename node_t>
+    void detach( node_t& node ) const
+    {
+        for( const auto& dep : m_deps )
+        {
+            node.get_graph().on_node_detach( node, *dep );
+        }
+    }
+
+    template <typename node_t, typename functor_t>
+    void attach_rec( const functor_t& functor ) const
+    {
+        attach( functor.node );
+    }
+
+    template <typename node_t, typename functor_t>
+    void detach_rec( const functor_t& functor ) const
+    {
+        detach( functor.node );
+    }
+
+private:
+    // Recursion instead of accumulating in a loop passes intermediate results as temporaries,
+    // so values are not copied or moved more than in the equivalent nested function_op
+    S evaluate_to( const size_t last )
+    {
+        return last == 1 ? m_func( m_deps[0]->value_ref(), m_deps[1]->value_ref() )
+                         : m_func( evaluate_to( last - 1 ), m_deps[last]->value_ref() );
+    }
+
+    std::vector<signal_node_ptr_t<S>> m_deps;
+    F m_func;
+};
+
+
 template <typename S, typename op_t>
 class signal_op_node : public signal_node<S>
 {
@@ -1245,6 +3129,7 @@ public:
 
             if( !equals( this->m_value, new_value ) )
             {
+                UREACT_ALLOC_SCOPE( value_copy );
                 this->m_value = std::move( new_value );
                 changed = true;
             }
@@ -1256,6 +3141,11 @@ public:
         }
     }
 
+    bool is_parallel_safe() const override
+    {
+        return op_t::parallel_safe::value;
+    }
+
     op_t steal_op()
     {
         assert( !m_was_op_stolen && "Op was already stolen." );
@@ -1297,33 +3187,254 @@ public:
     flatten_node( flatten_node&& ) noexcept = delete;
     flatten_node& operator=( flatten_node&& ) noexcept = delete;
 
-    void tick() override
-    {
-        const auto& new_inner = get_node_ptr( m_outer->value_ref() );
+    void tick() override
+    {
+        const auto& new_inner = get_node_ptr( m_outer->value_ref() );
+
+        if( new_inner != m_inner )
+        {
+            // Topology has been changed
+            auto old_inner = m_inner;
+            m_inner = new_inner;
+
+            flatten_node::get_graph().on_dynamic_node_detach( *this, *old_inner );
+            flatten_node::get_graph().on_dynamic_node_attach( *this, *new_inner );
+
+            return;
+        }
+
+        if( !equals( this->m_value, m_inner->value_ref() ) )
+        {
+            this->m_value = m_inner->value_ref();
+            flatten_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+private:
+    std::shared_ptr<signal_node<outer_t>> m_outer;
+    std::shared_ptr<signal_node<inner_t>> m_inner;
+};
+
+
+/// Node that follows one of its branches chosen by the value of the index node.
+/// Only the index and the active branch are attached, so changes of other branches
+/// don't schedule the node
+template <typename index_t, typename S>
+class select_node : public signal_node<S>
+{
+public:
+    select_node( context& context,
+        std::shared_ptr<signal_node<index_t>> index,
+        std::vector<std::shared_ptr<signal_node<S>>> branches )
+        : select_node::signal_node( context )
+        , m_index( std::move( index ) )
+        , m_branches( std::move( branches ) )
+        , m_active( active_branch() )
+    {
+        this->m_value = m_active->value_ref();
+
+        select_node::get_graph().on_node_attach( *this, *m_index );
+        select_node::get_graph().on_node_attach( *this, *m_active );
+    }
+
+    ~select_node() override
+    {
+        select_node::get_graph().on_node_detach( *this, *m_active );
+        select_node::get_graph().on_node_detach( *this, *m_index );
+    }
+
+    // Nodes can't be copied
+    select_node( const select_node& ) = delete;
+    select_node& operator=( const select_node& ) = delete;
+    select_node( select_node&& ) noexcept = delete;
+    select_node& operator=( select_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        const auto& new_active = active_branch();
+
+        if( new_active != m_active )
+        {
+            // Topology has been changed
+            auto old_active = m_active;
+            m_active = new_active;
+
+            select_node::get_graph().on_dynamic_node_detach( *this, *old_active );
+            select_node::get_graph().on_dynamic_node_attach( *this, *new_active );
+
+            return;
+        }
+
+        if( !equals( this->m_value, m_active->value_ref() ) )
+        {
+            this->m_value = m_active->value_ref();
+            select_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+private:
+    const std::shared_ptr<signal_node<S>>& active_branch() const
+    {
+        const auto i = static_cast<size_t>( m_index->value_ref() );
+        assert( i < m_branches.size() && "Index of the selected signal is out of range" );
+        return m_branches[i < m_branches.size() ? i : m_branches.size() - 1];
+    }
+
+    std::shared_ptr<signal_node<index_t>> m_index;
+    std::vector<std::shared_ptr<signal_node<S>>> m_branches;
+    std::shared_ptr<signal_node<S>> m_active;
+};
+
+
+/// Node that takes values of the source node accepted by the predicate.
+/// Rejected values don't pulse successors, so the node keeps the last accepted one
+template <typename S, typename F>
+class filter_node : public signal_node<S>
+{
+public:
+    template <typename in_f, typename T>
+    filter_node(
+        context& context, std::shared_ptr<signal_node<S>> source, in_f&& pred, T&& initial )
+        : filter_node::signal_node( context, std::forward<T>( initial ) )
+        , m_source( std::move( source ) )
+        , m_pred( std::forward<in_f>( pred ) )
+    {
+        filter_node::get_graph().on_node_attach( *this, *m_source );
+    }
+
+    ~filter_node() override
+    {
+        filter_node::get_graph().on_node_detach( *this, *m_source );
+    }
+
+    // Nodes can't be copied
+    filter_node( const filter_node& ) = delete;
+    filter_node& operator=( const filter_node& ) = delete;
+    filter_node( filter_node&& ) noexcept = delete;
+    filter_node& operator=( filter_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        const S& new_value = m_source->value_ref();
+
+        if( m_pred( new_value ) && !equals( this->m_value, new_value ) )
+        {
+            this->m_value = new_value;
+            filter_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+    bool is_parallel_safe() const override
+    {
+        return is_parallel_safe_function<F>::value;
+    }
+
+private:
+    std::shared_ptr<signal_node<S>> m_source;
+    F m_pred;
+};
+
+
+/// Node that takes values of the source node while the enable node is true.
+/// When the gate is reopened, the node takes the current value of the source
+template <typename S>
+class gate_node : public signal_node<S>
+{
+public:
+    gate_node( context& context,
+        std::shared_ptr<signal_node<S>> source,
+        std::shared_ptr<signal_node<bool>> enable )
+        : gate_node::signal_node( context, source->value_ref() )
+        , m_source( std::move( source ) )
+        , m_enable( std::move( enable ) )
+    {
+        gate_node::get_graph().on_node_attach( *this, *m_source );
+        gate_node::get_graph().on_node_attach( *this, *m_enable );
+    }
+
+    ~gate_node() override
+    {
+        gate_node::get_graph().on_node_detach( *this, *m_enable );
+        gate_node::get_graph().on_node_detach( *this, *m_source );
+    }
+
+    // Nodes can't be copied
+    gate_node( const gate_node& ) = delete;
+    gate_node& operator=( const gate_node& ) = delete;
+    gate_node( gate_node&& ) noexcept = delete;
+    gate_node& operator=( gate_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        if( m_enable->value_ref() && !equals( this->m_value, m_source->value_ref() ) )
+        {
+            this->m_value = m_source->value_ref();
+            gate_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+    bool is_parallel_safe() const override
+    {
+        return true;
+    }
+
+private:
+    std::shared_ptr<signal_node<S>> m_source;
+    std::shared_ptr<signal_node<bool>> m_enable;
+};
+
+
+using dependency_list_t = std::vector<std::shared_ptr<reactive_node>>;
 
-        if( new_inner != m_inner )
-        {
-            // Topology has been changed
-            auto old_inner = m_inner;
-            m_inner = new_inner;
+/// Dependencies read during an evaluation of computed_node.
+/// Reads of already known dependencies are only flagged, so steady evaluations
+/// neither allocate nor copy shared pointers
+struct dependency_reads
+{
+    /// Dependencies of the previous evaluation ordered by address
+    const dependency_list_t* known = nullptr;
 
-            flatten_node::get_graph().on_dynamic_node_detach( *this, *old_inner );
-            flatten_node::get_graph().on_dynamic_node_attach( *this, *new_inner );
+    /// Flags of known dependencies that were read
+    std::vector<bool> known_read;
 
-            return;
-        }
+    /// Nodes read for the first time in order of reading
+    dependency_list_t added;
 
-        if( !equals( this->m_value, m_inner->value_ref() ) )
+    /// Index of the node in known or known->size() if it isn't there
+    size_t find_known( const reactive_node* node ) const
+    {
+        const auto it = std::lower_bound( known->begin(),
+            known->end(),
+            node,
+            []( const std::shared_ptr<reactive_node>& dep, const reactive_node* n ) {
+                return std::less<const reactive_node*>()( dep.get(), n );
+            } );
+        return it != known->end() && it->get() == node
+                 ? static_cast<size_t>( it - known->begin() )
+                 : known->size();
+    }
+};
+
+/// Add the node to the recorded reads
+inline void record_dependency_read(
+    dependency_reads& reads, const std::shared_ptr<reactive_node>& node )
+{
+    const size_t index = reads.find_known( node.get() );
+    if( index != reads.known->size() )
+    {
+        reads.known_read[index] = true;
+        return;
+    }
+
+    for( const auto& added : reads.added )
+    {
+        if( added.get() == node.get() )
         {
-            this->m_value = m_inner->value_ref();
-            flatten_node::get_graph().on_node_pulse( *this );
+            return;
         }
     }
-
-private:
-    std::shared_ptr<signal_node<outer_t>> m_outer;
-    std::shared_ptr<signal_node<inner_t>> m_inner;
-};
+    reads.added.push_back( node );
+}
 
 
 template <typename S, typename func_t>
@@ -1347,22 +3458,34 @@ public:
 
     void tick() override
     {
-        bool should_detach = false;
-
-        if( auto p = m_subject.lock() )
+        if( get_graph().defer_observer( *this ) )
         {
-            if( m_func( p->value_ref() ) == observer_action::stop_and_detach )
-            {
-                should_detach = true;
-            }
+            return;
         }
 
-        if( should_detach )
+        if( invoke() )
         {
             get_graph().queue_observer_for_detach( *this );
         }
     }
 
+    bool invoke() override
+    {
+        if( auto p = m_subject.lock() )
+        {
+            get_graph().on_observer_invoke( *this, *p );
+
+            return m_func( p->value_ref() ) == observer_action::stop_and_detach;
+        }
+
+        return false;
+    }
+
+    const reactive_node* subject() const override
+    {
+        return m_subject.lock().get();
+    }
+
     void unregister_self() override
     {
         if( auto p = m_subject.lock() )
@@ -1374,6 +3497,8 @@ public:
 private:
     void detach_observer() override
     {
+        UREACT_PROBE1( observer_detach, get_node_id( *this ) );
+
         if( auto p = m_subject.lock() )
         {
             get_graph().on_node_detach( *this, *p );
@@ -1579,6 +3704,9 @@ private:
     using node_t = ::ureact::detail::var_node<S>;
 
 public:
+    /// Default constructor creates invalid var_signal that is not connected to any node
+    var_signal() = default;
+
     /**
      * Construct var_signal from var_node.
      * @todo make it private and allow to call it only from make_var function
@@ -1712,9 +3840,166 @@ public:
 };
 
 
+/// Reads values of signals in the function of computed() and records them as its dependencies.
+/// Only reads made through it are tracked
+class dependency_reader
+{
+public:
+    explicit dependency_reader( detail::dependency_reads& reads )
+        : m_reads( reads )
+    {}
+
+    dependency_reader( const dependency_reader& ) = delete;
+    dependency_reader& operator=( const dependency_reader& ) = delete;
+
+    /// Return value of the signal
+    template <typename S>
+    auto operator()( const signal<S>& sig ) const -> const typename signal<S>::value_t&
+    {
+        const auto& node = get_node_ptr( sig );
+        detail::record_dependency_read( m_reads, node );
+        return node->value_ref();
+    }
+
+private:
+    detail::dependency_reads& m_reads;
+};
+
+
 namespace detail
 {
 
+/// Node which dependencies are signals read by its function during the last evaluation
+template <typename S, typename F>
+class computed_node : public signal_node<S>
+{
+public:
+    template <typename in_f>
+    computed_node( context& context, in_f&& func )
+        : computed_node( context, F( std::forward<in_f>( func ) ), dependency_reads() )
+    {}
+
+    ~computed_node() override
+    {
+        for( const auto& dep : m_deps )
+        {
+            computed_node::get_graph().on_node_detach( *this, *dep );
+        }
+    }
+
+    // Nodes can't be copied
+    computed_node( const computed_node& ) = delete;
+    computed_node& operator=( const computed_node& ) = delete;
+    computed_node( computed_node&& ) noexcept = delete;
+    computed_node& operator=( computed_node&& ) noexcept = delete;
+
+    void tick() override
+    {
+        S new_value = evaluate();
+
+        react_graph& graph = computed_node::get_graph();
+
+        // Keep read dependencies in order and detach the rest
+        size_t kept = 0;
+        for( size_t i = 0; i < m_deps.size(); ++i )
+        {
+            if( m_reads.known_read[i] )
+            {
+                if( kept != i )
+                {
+                    m_deps[kept] = std::move( m_deps[i] );
+                }
+                ++kept;
+            }
+            else
+            {
+                graph.on_dynamic_node_detach( *this, *m_deps[i] );
+            }
+        }
+        m_deps.resize( kept );
+
+        if( !m_reads.added.empty() )
+        {
+            for( size_t i = 0; i + 1 < m_reads.added.size(); ++i )
+            {
+                graph.on_node_attach( *this, *m_reads.added[i] );
+            }
+            reactive_node& last_added = *m_reads.added.back();
+
+            m_deps.insert( m_deps.end(),
+                std::make_move_iterator( m_reads.added.begin() ),
+                std::make_move_iterator( m_reads.added.end() ) );
+            m_reads.added.clear();
+            sort_deps();
+
+            // Topology has been changed. New dependencies could be not ticked yet,
+            // so the node is rescheduled with the updated level
+            graph.on_dynamic_node_attach( *this, last_added );
+            return;
+        }
+
+        if( !equals( this->m_value, new_value ) )
+        {
+            this->m_value = std::move( new_value );
+            graph.on_node_pulse( *this );
+        }
+    }
+
+private:
+    // The initial value is taken from the first evaluation, so S isn't required
+    // to be default constructible
+    computed_node( context& context, F&& func, dependency_reads&& first_reads )
+        : computed_node::signal_node( context, evaluate_first( func, first_reads ) )
+        , m_func( std::move( func ) )
+        , m_deps( std::move( first_reads.added ) )
+    {
+        sort_deps();
+
+        for( const auto& dep : m_deps )
+        {
+            computed_node::get_graph().on_node_attach( *this, *dep );
+        }
+    }
+
+    static S evaluate_first( F& func, dependency_reads& reads )
+    {
+        static const dependency_list_t no_deps;
+        reads.known = &no_deps;
+
+        dependency_reader reader( reads );
+        return func( reader );
+    }
+
+    S evaluate()
+    {
+        m_reads.known = &m_deps;
+        m_reads.known_read.assign( m_deps.size(), false );
+        m_reads.added.clear();
+
+        dependency_reader reader( m_reads );
+        return m_func( reader );
+    }
+
+    void sort_deps()
+    {
+        std::sort( m_deps.begin(),
+            m_deps.end(),
+            []( const std::shared_ptr<reactive_node>& lhs,
+                const std::shared_ptr<reactive_node>& rhs ) {
+                return std::less<const reactive_node*>()( lhs.get(), rhs.get() );
+            } );
+    }
+
+    F m_func;
+
+    // Ordered by address, so reads are looked up with binary search
+    dependency_list_t m_deps;
+
+    // Scratch state of evaluations
+    dependency_reads m_reads;
+};
+
+
 /**
  * This class exposes additional type information of the linked node, which enables
  * r-value based node merging at construction time.
@@ -1753,6 +4038,8 @@ template <typename V,
     class = typename std::enable_if<!is_signal<S>::value>::type>
 auto make_var_impl( context& context, V&& value ) -> var_signal<S>
 {
+    UREACT_ALLOC_SCOPE( node_creation );
+
     return var_signal<S>(
         std::make_shared<::ureact::detail::var_node<S>>( context, std::forward<V>( value ) ) );
 }
@@ -1760,6 +4047,8 @@ auto make_var_impl( context& context, V&& value ) -> var_signal<S>
 template <typename S>
 auto make_var_impl( context& context, std::reference_wrapper<S> value ) -> var_signal<S&>
 {
+    UREACT_ALLOC_SCOPE( node_creation );
+
     return var_signal<S&>(
         std::make_shared<::ureact::detail::var_node<std::reference_wrapper<S>>>( context, value ) );
 }
@@ -1770,6 +4059,8 @@ template <typename V,
     class = typename std::enable_if<is_signal<S>::value>::type>
 auto make_var_impl( context& context, V&& value ) -> var_signal<signal<inner_t>>
 {
+    UREACT_ALLOC_SCOPE( node_creation );
+
     return var_signal<signal<inner_t>>(
         std::make_shared<::ureact::detail::var_node<signal<inner_t>>>(
             context, std::forward<V>( value ) ) );
@@ -1779,6 +4070,8 @@ auto make_var_impl( context& context, V&& value ) -> var_signal<signal<inner_t>>
 template <typename S, typename op_t, typename... Args>
 auto make_temp_signal( context& context, Args&&... args ) -> temp_signal<S, op_t>
 {
+    UREACT_ALLOC_SCOPE( node_creation );
+
     return temp_signal<S, op_t>(
         std::make_shared<signal_op_node<S, op_t>>( context, std::forward<Args>( args )... ) );
 }
@@ -1852,6 +4145,28 @@ public:
         return m_node_ptr != nullptr;
     }
 
+    /// Return id of the linked observer node. Diagnostic tools identify nodes by it.
+    friend detail::node_id_t node_id( const observer& obs )
+    {
+        assert( obs.is_valid() );
+        return detail::get_node_id( *obs.m_node_ptr );
+    }
+
+    /// Set name of the linked observer node. The name should outlive the node.
+    friend void set_debug_name( const observer& obs, const char* name )
+    {
+        assert( obs.is_valid() );
+        detail::debug_names::set( *obs.m_node_ptr, name );
+    }
+
+    /// Mark the linked observer as critical. Critical observers are invoked during propagation,
+    /// while the other observers of the turn are deferred until it ends
+    friend void set_critical( const observer& obs )
+    {
+        assert( obs.is_valid() );
+        obs.m_node_ptr->get_graph().set_critical( *obs.m_node_ptr );
+    }
+
 private:
     /// Owned by subject
     node_t* m_node_ptr = nullptr;
@@ -2011,6 +4326,45 @@ auto binary_operator_impl( detail::temp_signal<left_val_t, left_op_t>&& lhs,
     return make_temp_signal<S, op_t>( context, F(), lhs.steal_op(), rhs.steal_op() );
 }
 
+// The third operand of the same type turns a binary op into fold_op
+template <template <typename, typename> class functor_op,
+    typename val_t,
+    typename right_signal_t,
+    class = typename std::enable_if<is_signal<right_signal_t>::value>::type,
+    class = typename std::enable_if<
+        std::is_same<val_t, typename right_signal_t::value_t>::value>::type,
+    typename op_t = fold_op<val_t, functor_op<val_t, val_t>>>
+auto binary_operator_impl( temp_signal<val_t,
+                              function_op<val_t,
+                                  functor_op<val_t, val_t>,
+                                  signal_node_ptr_t<val_t>,
+                                  signal_node_ptr_t<val_t>>>&& lhs,
+    const right_signal_t& rhs ) -> temp_signal<val_t, op_t>
+{
+    context& context = rhs.get_context();
+
+    return make_temp_signal<val_t, op_t>( context, lhs.steal_op(), get_node_ptr( rhs ) );
+}
+
+// Next operands are appended to fold_op
+template <template <typename, typename> class functor_op,
+    typename val_t,
+    typename right_signal_t,
+    class = typename std::enable_if<is_signal<right_signal_t>::value>::type,
+    class = typename std::enable_if<
+        std::is_same<val_t, typename right_signal_t::value_t>::value>::type,
+    typename op_t = fold_op<val_t, functor_op<val_t, val_t>>>
+auto binary_operator_impl( temp_signal<val_t, fold_op<val_t, functor_op<val_t, val_t>>>&& lhs,
+    const right_signal_t& rhs ) -> temp_signal<val_t, op_t>
+{
+    context& context = rhs.get_context();
+
+    op_t op = lhs.steal_op();
+    op.append( get_node_ptr( rhs ) );
+
+    return make_temp_signal<val_t, op_t>( context, std::move( op ) );
+}
+
 template <template <typename, typename> class functor_op,
     typename left_val_t,
     typename left_op_t,
@@ -2091,7 +4445,7 @@ auto binary_operator_impl( left_val_in_t&& lhs, detail::temp_signal<right_val_t,
         namespace op_functors                                                                      \
         {                                                                                          \
         template <typename T>                                                                      \
-        struct op_functor_##name                                                                   \
+        struct op_functor_##name : parallel_safe_tag                                               \
         {                                                                                          \
             auto operator()( const T& v ) const -> decltype( op std::declval<T>() )                \
             {                                                                                      \
@@ -2108,7 +4462,7 @@ auto binary_operator_impl( left_val_in_t&& lhs, detail::temp_signal<right_val_t,
         namespace op_functors                                                                      \
         {                                                                                          \
         template <typename L, typename R>                                                          \
-        struct op_functor_##name                                                                   \
+        struct op_functor_##name : parallel_safe_tag                                               \
         {                                                                                          \
             auto operator()( const L& lhs, const R& rhs ) const                                    \
                 -> decltype( std::declval<L>() op std::declval<R>() )                              \
@@ -2240,7 +4594,19 @@ auto operator,( const signal_pack<cur_values_t...>& cur, const signal<append_val
 }
 
 
+/// Mark the function of make_signal() or the predicate of filter() as parallel safe,
+/// so the node can be ticked on worker threads of a level executor (see parallel_executor.hpp)
+/// concurrently with other nodes of its level. Such a function should only compute its result
+/// from the arguments. Unmarked functions are always called on the propagating thread
+template <typename in_f>
+auto parallel_safe( in_f&& func ) -> detail::parallel_safe_function<typename std::decay<in_f>::type>
+{
+    return detail::parallel_safe_function<typename std::decay<in_f>::type>(
+        std::forward<in_f>( func ) );
+}
+
 /// Free function to connect a signal to a function and return the resulting signal.
+/// Func is called on worker threads of a level executor only if it is wrapped with parallel_safe
 template <typename value_t,
     typename in_f,
     typename F = typename std::decay<in_f>::type,
@@ -2256,6 +4622,7 @@ auto make_signal( const signal<value_t>& arg, in_f&& func ) -> detail::temp_sign
 }
 
 /// Free function to connect multiple signals to a function and return the resulting signal.
+/// Func is called on worker threads of a level executor only if it is wrapped with parallel_safe
 template <typename... values_t,
     typename in_f,
     typename F = typename std::decay<in_f>::type,
@@ -2309,16 +4676,132 @@ auto operator->*( const signal_pack<values_t...>& arg_pack, F&& func )
 }
 
 
+/// Return id of the node linked to the given signal.
+/// Diagnostic tools like flight_recorder identify nodes by it.
+template <typename S>
+auto node_id( const signal<S>& s ) -> detail::node_id_t
+{
+    assert( s.is_valid() );
+    return detail::get_node_id( *get_node_ptr( s ) );
+}
+
+
+/// Set name of the node linked to the given signal. It is used by diagnostic tools.
+/// The name isn't copied, so it should outlive the node.
+template <typename S>
+void set_debug_name( const signal<S>& s, const char* name )
+{
+    assert( s.is_valid() );
+    detail::debug_names::set( *get_node_ptr( s ), name );
+}
+
+/// Return name of the node linked to the given signal or nullptr if it isn't set.
+template <typename S>
+auto debug_name( const signal<S>& s ) -> const char*
+{
+    assert( s.is_valid() );
+    return detail::debug_names::get( *get_node_ptr( s ) );
+}
+
+
 template <typename inner_value_t>
 auto flatten( const signal<signal<inner_value_t>>& outer ) -> signal<inner_value_t>
 {
     context& context = outer.get_context();
+    UREACT_ALLOC_SCOPE( node_creation );
+
     return signal<inner_value_t>(
         std::make_shared<::ureact::detail::flatten_node<signal<inner_value_t>, inner_value_t>>(
             context, get_node_ptr( outer ), get_node_ptr( outer.value() ) ) );
 }
 
 
+/// Create a signal that has the value of the signal selected by index.
+/// Only the index and the selected signal are tracked, so changes of other signals
+/// cause no work. Index should be less than the number of signals
+template <typename index_t, typename S, typename... signals_t>
+auto select( const signal<index_t>& index, const signal<S>& first, const signals_t&... rest )
+    -> signal<S>
+{
+    using node_ptr_t = std::shared_ptr<::ureact::detail::signal_node<S>>;
+
+    context& context = index.get_context();
+    UREACT_ALLOC_SCOPE( node_creation );
+
+    return signal<S>( std::make_shared<::ureact::detail::select_node<index_t, S>>( context,
+        get_node_ptr( index ),
+        std::vector<node_ptr_t>{ get_node_ptr( first ), get_node_ptr( rest )... } ) );
+}
+
+/// Create a signal that takes values of the source accepted by pred and keeps the last
+/// accepted value otherwise. Rejected values don't propagate further.
+/// Initial value is given explicitly, pred isn't called for it.
+/// Pred is called on worker threads of a level executor only if it is wrapped with parallel_safe
+template <typename S, typename in_f, typename T>
+auto filter( const signal<S>& source, in_f&& pred, T&& initial ) -> signal<S>
+{
+    using F = typename std::decay<in_f>::type;
+
+    context& context = source.get_context();
+    UREACT_ALLOC_SCOPE( node_creation );
+
+    return signal<S>( std::make_shared<::ureact::detail::filter_node<S, F>>( context,
+        get_node_ptr( source ),
+        std::forward<in_f>( pred ),
+        std::forward<T>( initial ) ) );
+}
+
+/// Same as filter() with the initial value, which is the current value of the source.
+/// It is taken even if pred rejects it
+template <typename S, typename in_f>
+auto filter( const signal<S>& source, in_f&& pred ) -> signal<S>
+{
+    return filter( source, std::forward<in_f>( pred ), source.value() );
+}
+
+/// Create a signal that takes values of the source while enable is true.
+/// Changes of the source don't propagate further while the gate is closed.
+/// Initial value is the current value of the source
+template <typename S>
+auto gate( const signal<S>& source, const signal<bool>& enable ) -> signal<S>
+{
+    context& context = source.get_context();
+    UREACT_ALLOC_SCOPE( node_creation );
+
+    return signal<S>( std::make_shared<::ureact::detail::gate_node<S>>(
+        context, get_node_ptr( source ), get_node_ptr( enable ) ) );
+}
+
+/// Create a signal evaluated by func(read) that depends on exactly the signals which values
+/// were read with dependency_reader read by the last evaluation. When func reads different
+/// signals depending on data, only changes of the signals read last time cause reevaluation.
+/// Initial value is the result of the first evaluation
+template <typename in_f>
+auto computed( context& context, in_f&& func ) -> signal<typename std::decay<
+    typename std::result_of<in_f( dependency_reader& )>::type>::type>
+{
+    using F = typename std::decay<in_f>::type;
+    using S = typename std::decay<
+        typename std::result_of<in_f( dependency_reader& )>::type>::type;
+
+    UREACT_ALLOC_SCOPE( node_creation );
+
+    return signal<S>( std::make_shared<::ureact::detail::computed_node<S, F>>(
+        context, std::forward<in_f>( func ) ) );
+}
+
+/// Create a signal that has the value of then_signal while condition is true
+/// and the value of else_signal otherwise. Only the active branch is tracked
+template <typename S>
+auto if_then_else( const signal<bool>& condition,
+    const signal<S>& then_signal,
+    const signal<S>& else_signal ) -> signal<S>
+{
+    // false selects the first signal
+    return select( condition, else_signal, then_signal );
+}
+
+
 /// When the signal value S of subject changes, func(s) is called.
 /// The signature of func should be equivalent to:
 /// TRet func(const S&)
@@ -2346,6 +4829,8 @@ auto observe( const signal<S>& subject, in_f&& func ) -> observer
 
     const auto& subject_ptr = get_node_ptr( subject );
 
+    UREACT_ALLOC_SCOPE( observer_registration );
+
     std::unique_ptr<observer_node> node_ptr(
         new node_t( subject.get_context(), subject_ptr, std::forward<in_f>( func ) ) );
     observer_node* raw_node_ptr = node_ptr.get();
@@ -2387,6 +4872,26 @@ auto observe( const signal<S>& subject, in_f&& func ) -> observer
 class context : protected detail::context_internals
 {
 public:
+    /// Create context with the default level by level scheduler
+    context() = default;
+
+    /// Create context that uses the given scheduler for propagation turns
+    explicit context( std::unique_ptr<scheduler> custom_scheduler )
+        : context_internals( threading_policy::single_threaded, std::move( custom_scheduler ) )
+    {}
+
+    /// Create context with the given threading policy and optionally a custom scheduler
+    explicit context( const threading_policy policy,
+        std::unique_ptr<scheduler> custom_scheduler = nullptr )
+        : context_internals( policy, std::move( custom_scheduler ) )
+    {}
+
+    /// Return threading policy the context was created with
+    threading_policy get_threading_policy() const
+    {
+        return get_graph().get_threading_policy();
+    }
+
     /// Perform several changes atomically
     template <typename F>
     void do_transaction( F&& func )
@@ -2394,6 +4899,22 @@ public:
         get_graph().do_transaction( std::forward<F>( func ) );
     }
 
+    /// Perform several changes atomically with the given priority.
+    /// See threading_policy and turn_priority
+    template <typename F>
+    void do_transaction( const turn_priority priority, F&& func )
+    {
+        get_graph().do_transaction( priority, std::forward<F>( func ) );
+    }
+
+    /// Perform a range of transactions with the same result as performing them one by one.
+    /// Independent transactions are propagated together. See react_graph::do_transactions
+    template <typename R>
+    void do_transactions( R&& transactions )
+    {
+        get_graph().do_transactions( std::forward<R>( transactions ) );
+    }
+
     /// Factory function to create var signal in the current context.
     template <typename V>
     auto make_var( V&& value ) -> decltype( ureact::make_var( *this, std::forward<V>( value ) ) )
@@ -2401,6 +4922,12 @@ public:
         return ureact::make_var( *this, std::forward<V>( value ) );
     }
 
+    /// Return id of the current propagation turn or of the last finished one
+    detail::turn_id_t current_turn() const
+    {
+        return get_graph().current_turn();
+    }
+
     bool operator==( const context& rsh ) const
     {
         return this == &rsh;
@@ -2418,7 +4945,71 @@ public:
     }
 };
 
+namespace detail
+{
+
+/*! @brief Turn listener attached to a context for its whole lifetime
+ *
+ *  Base of diagnostic tools that listen to turns. It is added to the graph on construction
+ *  and removed on destruction, so a tool derived from it should be destroyed before
+ *  the context it is attached to.
+ */
+class scoped_turn_listener : public turn_listener
+{
+public:
+    explicit scoped_turn_listener( context& ctx )
+        : m_context( ctx )
+    {
+        _get_internals( m_context ).get_graph().add_turn_listener( *this );
+    }
+
+    scoped_turn_listener( const scoped_turn_listener& ) = delete;
+    scoped_turn_listener& operator=( const scoped_turn_listener& ) = delete;
+    scoped_turn_listener( scoped_turn_listener&& ) noexcept = delete;
+    scoped_turn_listener& operator=( scoped_turn_listener&& ) noexcept = delete;
+
+    ~scoped_turn_listener() override
+    {
+        _get_internals( m_context ).get_graph().remove_turn_listener( *this );
+    }
+
+private:
+    context& m_context;
+};
+
+/*! @brief Turn recorder attached to a context for its whole lifetime
+ *
+ *  Base of diagnostic tools fed by turn summaries. Lifetime rules are the same as for
+ *  scoped_turn_listener: a tool derived from it should be destroyed before its context.
+ */
+class scoped_turn_recorder : public turn_recorder
+{
+public:
+    explicit scoped_turn_recorder( context& ctx )
+        : m_context( ctx )
+    {
+        _get_internals( m_context ).get_graph().add_turn_recorder( *this );
+    }
+
+    scoped_turn_recorder( const scoped_turn_recorder& ) = delete;
+    scoped_turn_recorder& operator=( const scoped_turn_recorder& ) = delete;
+    scoped_turn_recorder( scoped_turn_recorder&& ) noexcept = delete;
+    scoped_turn_recorder& operator=( scoped_turn_recorder&& ) noexcept = delete;
+
+    ~scoped_turn_recorder() override
+    {
+        _get_internals( m_context ).get_graph().remove_turn_recorder( *this );
+    }
+
+private:
+    context& m_context;
+};
+
+} // namespace detail
+
 #undef UREACT_EXPAND_PACK
+#undef UREACT_PROBE1
+#undef UREACT_PROBE2
 
 UREACT_END_NAMESPACE
 
@@ -0,0 +1,352 @@
+// wasted_work_analyzer.hpp - detection of redundant recomputations
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_WASTED_WORK_ANALYZER_H_
+#define UREACT_WASTED_WORK_ANALYZER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Possible way to eliminate wasted work of a node
+enum class wasted_work_suggestion
+{
+    none,                 ///< Nothing to suggest
+    memoize,              ///< Node often recalculates the same value. Memoize or narrow inputs
+    tolerance_comparator, ///< Node changes are mostly ignored by successors. Compare with tolerance
+    upstream_filter       ///< Input changes mostly don't reach observers. Filter them upstream
+};
+
+/// Return name of the suggestion
+inline const char* to_string( const wasted_work_suggestion suggestion )
+{
+    switch( suggestion )
+    {
+        case wasted_work_suggestion::memoize: return "memoize";
+        case wasted_work_suggestion::tolerance_comparator: return "tolerance_comparator";
+        case wasted_work_suggestion::upstream_filter: return "upstream_filter";
+        default: return "none";
+    }
+}
+
+/// Wasted work statistics of a single node
+struct wasted_work_entry
+{
+    detail::node_id_t node = 0; ///< Id of the node
+    std::string name;           ///< Debug name of the node if any
+
+    std::uint64_t ticks = 0;           ///< Number of ticks
+    std::uint64_t unchanged_ticks = 0; ///< Ticks that didn't change the value
+    std::uint64_t wasted_ns = 0;       ///< Time spent in ticks that didn't change the value
+
+    std::uint64_t changes = 0;           ///< Value changes including input changes
+    std::uint64_t absorbed_changes = 0;  ///< Changes that none of successors reacted to
+    std::uint64_t fruitless_changes = 0; ///< Input changes in turns without observer invocations
+
+    wasted_work_suggestion suggestion = wasted_work_suggestion::none;
+};
+
+
+/*! @brief Counts ticks that didn't change node values and changes that didn't go anywhere
+ *
+ *  For every node it counts ticks that ended with equal value (unchanged ticks), changes
+ *  that were not picked up by any successor (absorbed changes) and input changes made in turns
+ *  where no observer was invoked (fruitless changes).
+ */
+class wasted_work_analyzer : private detail::scoped_turn_listener
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// Suggestions are made if a ratio of wasted ticks or changes reaches the threshold
+    explicit wasted_work_analyzer( context& ctx, const double threshold = 0.5 )
+        : scoped_turn_listener( ctx )
+        , m_threshold( threshold )
+    {}
+
+    wasted_work_analyzer( const wasted_work_analyzer& ) = delete;
+    wasted_work_analyzer& operator=( const wasted_work_analyzer& ) = delete;
+    wasted_work_analyzer( wasted_work_analyzer&& ) noexcept = delete;
+    wasted_work_analyzer& operator=( wasted_work_analyzer&& ) noexcept = delete;
+
+    /// Return statistics of nodes with any waste with suggestions. The most wasteful go first
+    std::vector<wasted_work_entry> report() const
+    {
+        std::vector<wasted_work_entry> result;
+        for( const auto& p : m_nodes )
+        {
+            const node_stats& stats = p.second;
+            const std::uint64_t waste
+                = stats.unchanged_ticks + stats.absorbed_changes + stats.fruitless_changes;
+            if( waste == 0 )
+            {
+                continue;
+            }
+
+            wasted_work_entry entry;
+            entry.node = p.first;
+            entry.name = stats.name;
+            entry.ticks = stats.ticks;
+            entry.unchanged_ticks = stats.unchanged_ticks;
+            entry.wasted_ns = stats.wasted_ns;
+            entry.changes = stats.changes;
+            entry.absorbed_changes = stats.absorbed_changes;
+            entry.fruitless_changes = stats.fruitless_changes;
+            entry.suggestion = suggest( stats );
+            result.push_back( std::move( entry ) );
+        }
+
+        std::sort( result.begin(),
+            result.end(),
+            []( const wasted_work_entry& lhs, const wasted_work_entry& rhs ) {
+                const std::uint64_t lhs_waste
+                    = lhs.unchanged_ticks + lhs.absorbed_changes + lhs.fruitless_changes;
+                const std::uint64_t rhs_waste
+                    = rhs.unchanged_ticks + rhs.absorbed_changes + rhs.fruitless_changes;
+                if( lhs_waste != rhs_waste )
+                {
+                    return lhs_waste > rhs_waste;
+                }
+                return lhs.wasted_ns > rhs.wasted_ns;
+            } );
+
+        return result;
+    }
+
+    /// Return report() as a table with one node per line
+    std::string report_text() const
+    {
+        std::string result
+            = "node ticks unchanged_ticks wasted_ns changes absorbed fruitless suggestion\n";
+        for( const wasted_work_entry& entry : report() )
+        {
+            result += entry.name.empty() ? "#" + std::to_string( entry.node ) : entry.name;
+            result += ' ' + std::to_string( entry.ticks );
+            result += ' ' + std::to_string( entry.unchanged_ticks );
+            result += ' ' + std::to_string( entry.wasted_ns );
+            result += ' ' + std::to_string( entry.changes );
+            result += ' ' + std::to_string( entry.absorbed_changes );
+            result += ' ' + std::to_string( entry.fruitless_changes );
+            result += ' ';
+            result += to_string( entry.suggestion );
+            result += '\n';
+        }
+        return result;
+    }
+
+    /// Forget all collected statistics
+    void reset()
+    {
+        m_nodes.clear();
+    }
+
+private:
+    struct node_stats
+    {
+        std::string name;
+
+        std::uint64_t ticks = 0;
+        std::uint64_t unchanged_ticks = 0;
+        std::uint64_t wasted_ns = 0;
+
+        std::uint64_t changes = 0;
+        std::uint64_t absorbed_changes = 0;
+        std::uint64_t fruitless_changes = 0;
+
+        bool is_input = false;
+
+        // Turns of the last events to match them during the turn end processing
+        detail::turn_id_t last_change_turn = 0;
+        detail::turn_id_t last_invoke_turn = 0;
+    };
+
+    wasted_work_suggestion suggest( const node_stats& stats ) const
+    {
+        const auto reaches = [this]( std::uint64_t part, std::uint64_t total ) {
+            return total != 0
+                && static_cast<double>( part ) >= m_threshold * static_cast<double>( total );
+        };
+
+        if( stats.is_input && reaches( stats.fruitless_changes, stats.changes ) )
+        {
+            return wasted_work_suggestion::upstream_filter;
+        }
+        if( reaches( stats.unchanged_ticks, stats.ticks ) )
+        {
+            return wasted_work_suggestion::memoize;
+        }
+        if( reaches( stats.absorbed_changes, stats.changes ) )
+        {
+            return wasted_work_suggestion::tolerance_comparator;
+        }
+        return wasted_work_suggestion::none;
+    }
+
+    node_stats& stats_of( const detail::reactive_node& node )
+    {
+        node_stats& stats = m_nodes[detail::get_node_id( node )];
+        if( stats.name.empty() && node.has_debug_name )
+        {
+            stats.name = detail::debug_names::get( node );
+        }
+        return stats;
+    }
+
+    void on_turn_begin( const detail::turn_id_t turn ) override
+    {
+        m_turn = turn;
+        m_observers_invoked = false;
+        m_changed_nodes.clear();
+        m_changed_successors.clear();
+        m_changed_ids.clear();
+    }
+
+    void on_turn_end( detail::turn_id_t /*turn*/ ) override
+    {
+        for( const changed_node& changed : m_changed_nodes )
+        {
+            node_stats& stats = m_nodes[changed.node];
+
+            if( stats.is_input && !m_observers_invoked )
+            {
+                ++stats.fruitless_changes;
+            }
+
+            if( changed.successors_begin == changed.successors_end )
+            {
+                continue;
+            }
+
+            bool picked_up = false;
+            for( std::size_t i = changed.successors_begin; i != changed.successors_end; ++i )
+            {
+                const auto it = m_nodes.find( m_changed_successors[i] );
+                if( it != m_nodes.end()
+                    && ( it->second.last_change_turn == m_turn
+                         || it->second.last_invoke_turn == m_turn ) )
+                {
+                    picked_up = true;
+                    break;
+                }
+            }
+
+            if( !picked_up )
+            {
+                ++stats.absorbed_changes;
+            }
+        }
+    }
+
+    void on_input_applied( const detail::reactive_node& node ) override
+    {
+        node_stats& stats = stats_of( node );
+        stats.is_input = true;
+        ++stats.changes;
+        stats.last_change_turn = m_turn;
+        add_changed_node( node );
+    }
+
+    void on_tick_begin( const detail::reactive_node& /*node*/ ) override
+    {
+        m_ticks.push_back( tick_state{ clock::now(), false } );
+    }
+
+    void on_tick_end( const detail::reactive_node& node ) override
+    {
+        const tick_state tick = m_ticks.back();
+        m_ticks.pop_back();
+
+        const auto elapsed = clock::now() - tick.start;
+
+        node_stats& stats = stats_of( node );
+        ++stats.ticks;
+
+        if( !tick.changed && stats.last_invoke_turn != m_turn )
+        {
+            ++stats.unchanged_ticks;
+            stats.wasted_ns += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count() );
+        }
+    }
+
+    void on_node_pulse( const detail::reactive_node& node ) override
+    {
+        if( !m_ticks.empty() )
+        {
+            m_ticks.back().changed = true;
+        }
+
+        node_stats& stats = stats_of( node );
+        ++stats.changes;
+        stats.last_change_turn = m_turn;
+        add_changed_node( node );
+    }
+
+    // Nodes can be destroyed before the turn ends, so only ids are kept. Successors are
+    // read at the first change, while the node is alive. Each node is processed once a turn
+    void add_changed_node( const detail::reactive_node& node )
+    {
+        const detail::node_id_t id = detail::get_node_id( node );
+        if( !m_changed_ids.insert( id ).second )
+        {
+            return;
+        }
+
+        const std::size_t successors_begin = m_changed_successors.size();
+        for( const detail::reactive_node* succ : node.successors )
+        {
+            m_changed_successors.push_back( detail::get_node_id( *succ ) );
+        }
+        m_changed_nodes.push_back(
+            changed_node{ id, successors_begin, m_changed_successors.size() } );
+    }
+
+    void on_observer_invoke( const detail::reactive_node& node ) override
+    {
+        m_observers_invoked = true;
+        stats_of( node ).last_invoke_turn = m_turn;
+    }
+
+    double m_threshold;
+
+    std::unordered_map<detail::node_id_t, node_stats> m_nodes;
+
+    detail::turn_id_t m_turn = 0;
+    bool m_observers_invoked = false;
+
+    struct changed_node
+    {
+        detail::node_id_t node;
+        std::size_t successors_begin; // Range of successor ids in m_changed_successors
+        std::size_t successors_end;
+    };
+    std::vector<changed_node> m_changed_nodes;
+    std::vector<detail::node_id_t> m_changed_successors;
+    std::unordered_set<detail::node_id_t> m_changed_ids;
+
+    // Running ticks, the innermost last
+    struct tick_state
+    {
+        clock::time_point start;
+        bool changed;
+    };
+    std::vector<tick_state> m_ticks;
+};
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_WASTED_WORK_ANALYZER_H_
@@ -0,0 +1,640 @@
+// window.hpp - sliding window aggregations over signal values
+//
+// MIT License
+//
+// Copyright (c) 2020 - present Krylov Yaroslav
+//
+// Distributed under the MIT Software License
+// See accompanying file LICENSE.txt or copy at
+// https://opensource.org/licenses/MIT
+
+#ifndef UREACT_WINDOW_H_
+#define UREACT_WINDOW_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ureact.hpp"
+
+UREACT_BEGIN_NAMESPACE
+
+/// Window of the last given number of samples
+class count_window
+{
+public:
+    explicit count_window( const size_t samples )
+        : m_samples( samples )
+    {
+        assert( samples != 0 && "Window should contain at least one sample" );
+    }
+
+    size_t samples() const
+    {
+        return m_samples;
+    }
+
+private:
+    size_t m_samples;
+};
+
+
+/// Window of samples recorded during the last given time period.
+/// Time is taken from the clock, which can be any object with now() like std::chrono clocks.
+/// Samples that left the window are evicted when the window signal is updated,
+/// i.e. when a new sample is recorded or the timer set with evict_on() changes
+template <typename clock_type = std::chrono::steady_clock>
+class time_window
+{
+public:
+    using duration = typename clock_type::duration;
+    using time_point = typename clock_type::time_point;
+
+    explicit time_window( const duration length, clock_type clock = clock_type() )
+        : m_length( length )
+        , m_clock( std::move( clock ) )
+    {}
+
+    /// Evict samples that left the window on every change of the timer,
+    /// e.g. of a var updated periodically, without recording new samples
+    template <typename T>
+    time_window& evict_on( const signal<T>& timer )
+    {
+        m_timer = get_node_ptr( timer );
+        return *this;
+    }
+
+    duration length() const
+    {
+        return m_length;
+    }
+
+    time_point now() const
+    {
+        return m_clock.now();
+    }
+
+    const std::shared_ptr<detail::reactive_node>& timer() const
+    {
+        return m_timer;
+    }
+
+private:
+    duration m_length;
+    clock_type m_clock;
+    std::shared_ptr<detail::reactive_node> m_timer;
+};
+
+
+namespace detail
+{
+
+/// Growable FIFO queue in contiguous storage with power of two capacity
+template <typename T>
+class ring_buffer
+{
+public:
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const T& front() const
+    {
+        return m_data[m_head];
+    }
+
+    const T& back() const
+    {
+        return m_data[( m_head + m_size - 1 ) & ( m_data.size() - 1 )];
+    }
+
+    void push_back( T value )
+    {
+        if( m_size == m_data.size() )
+        {
+            grow();
+        }
+        m_data[( m_head + m_size ) & ( m_data.size() - 1 )] = std::move( value );
+        ++m_size;
+    }
+
+    void pop_front()
+    {
+        m_head = ( m_head + 1 ) & ( m_data.size() - 1 );
+        --m_size;
+    }
+
+    void pop_back()
+    {
+        --m_size;
+    }
+
+    /// Call func( const T* data, size_t count ) for at most two contiguous parts of the queue
+    template <typename F>
+    void for_each_segment( F&& func ) const
+    {
+        const size_t first = m_size < m_data.size() - m_head ? m_size : m_data.size() - m_head;
+        if( first != 0 )
+        {
+            func( m_data.data() + m_head, first );
+        }
+        if( first != m_size )
+        {
+            func( m_data.data(), m_size - first );
+        }
+    }
+
+private:
+    void grow()
+    {
+        std::vector<T> data( m_data.empty() ? 8 : m_data.size() * 2 );
+        for( size_t i = 0; i < m_size; ++i )
+        {
+            data[i] = std::move( m_data[( m_head + i ) & ( m_data.size() - 1 )] );
+        }
+        m_data.swap( data );
+        m_head = 0;
+    }
+
+    std::vector<T> m_data;
+    size_t m_head = 0;
+    size_t m_size = 0;
+};
+
+
+template <typename window_t>
+class window_state;
+
+template <>
+class window_state<count_window>
+{
+public:
+    explicit window_state( const count_window& window )
+        : m_window( window )
+    {}
+
+    void on_push()
+    {}
+
+    void refresh()
+    {}
+
+    bool should_evict( const size_t size ) const
+    {
+        return size > m_window.samples();
+    }
+
+    void on_pop()
+    {}
+
+    std::shared_ptr<reactive_node> timer() const
+    {
+        return nullptr;
+    }
+
+private:
+    count_window m_window;
+};
+
+template <typename clock_type>
+class window_state<time_window<clock_type>>
+{
+public:
+    explicit window_state( const time_window<clock_type>& window )
+        : m_window( window )
+    {}
+
+    void on_push()
+    {
+        m_now = m_window.now();
+        m_stamps.push_back( m_now );
+    }
+
+    void refresh()
+    {
+        m_now = m_window.now();
+    }
+
+    bool should_evict( size_t /*size*/ ) const
+    {
+        return m_stamps.front() + m_window.length() <= m_now;
+    }
+
+    void on_pop()
+    {
+        m_stamps.pop_front();
+    }
+
+    const std::shared_ptr<reactive_node>& timer() const
+    {
+        return m_window.timer();
+    }
+
+    double seconds() const
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>( m_window.length() )
+            .count();
+    }
+
+private:
+    time_window<clock_type> m_window;
+    ring_buffer<typename clock_type::time_point> m_stamps;
+    typename clock_type::time_point m_now{};
+};
+
+
+/// Running sum. It is recomputed from samples once per window length
+/// to avoid accumulation of rounding errors of floating point values
+template <typename S>
+class sum_aggregator
+{
+public:
+    void push( const S& value, std::uint64_t /*seq*/ )
+    {
+        m_sum += value;
+    }
+
+    void pop( const S& value, std::uint64_t /*seq*/ )
+    {
+        m_sum -= value;
+        ++m_pops;
+    }
+
+    void maintain( const ring_buffer<S>& values )
+    {
+        if( m_pops < values.size() )
+        {
+            return;
+        }
+        m_pops = 0;
+
+        S sum{};
+        values.for_each_segment( [&sum]( const S* data, const size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+            {
+                sum += data[i];
+            }
+        } );
+        m_sum = sum;
+    }
+
+    const S& sum() const
+    {
+        return m_sum;
+    }
+
+private:
+    S m_sum{};
+    size_t m_pops = 0;
+};
+
+template <typename S>
+class mean_aggregator : public sum_aggregator<S>
+{
+public:
+    template <typename state_t>
+    double result( const size_t size, const state_t& /*state*/ ) const
+    {
+        return static_cast<double>( this->sum() ) / static_cast<double>( size );
+    }
+};
+
+template <typename S>
+class total_aggregator : public sum_aggregator<S>
+{
+public:
+    template <typename state_t>
+    S result( size_t /*size*/, const state_t& /*state*/ ) const
+    {
+        return this->sum();
+    }
+};
+
+/// Monotonic deque of samples that can become the extremum after older samples are evicted
+template <typename S, typename compare_t>
+class extremum_aggregator
+{
+public:
+    void push( const S& value, const std::uint64_t seq )
+    {
+        while( !m_candidates.empty() && !m_compare( m_candidates.back().second, value ) )
+        {
+            m_candidates.pop_back();
+        }
+        m_candidates.push_back( std::make_pair( seq, value ) );
+    }
+
+    void pop( const S& /*value*/, const std::uint64_t seq )
+    {
+        if( m_candidates.front().first == seq )
+        {
+            m_candidates.pop_front();
+        }
+    }
+
+    void maintain( const ring_buffer<S>& /*values*/ )
+    {}
+
+    template <typename state_t>
+    const S& result( size_t /*size*/, const state_t& /*state*/ ) const
+    {
+        return m_candidates.front().second;
+    }
+
+private:
+    ring_buffer<std::pair<std::uint64_t, S>> m_candidates;
+    compare_t m_compare;
+};
+
+// Older candidate stays while it is strictly better than the new value
+template <typename S>
+struct strictly_less
+{
+    bool operator()( const S& lhs, const S& rhs ) const
+    {
+        return lhs < rhs;
+    }
+};
+
+template <typename S>
+struct strictly_greater
+{
+    bool operator()( const S& lhs, const S& rhs ) const
+    {
+        return rhs < lhs;
+    }
+};
+
+/// Number of samples per second
+template <typename S>
+class rate_aggregator
+{
+public:
+    void push( const S& /*value*/, std::uint64_t /*seq*/ )
+    {}
+
+    void pop( const S& /*value*/, std::uint64_t /*seq*/ )
+    {}
+
+    void maintain( const ring_buffer<S>& /*values*/ )
+    {}
+
+    template <typename clock_type>
+    double result( const size_t size, const window_state<time_window<clock_type>>& state ) const
+    {
+        return static_cast<double>( size ) / state.seconds();
+    }
+};
+
+
+/// Node that aggregates samples of the window. Samples of a var source given as input are
+/// recorded when values are admitted, so equal values are counted too. Samples of other
+/// sources are recorded when they change. Samples outside of the window are evicted on every tick
+template <typename S, typename R, typename aggregator_t, typename window_t>
+class window_node : public signal_node<R>
+{
+public:
+    window_node( context& context,
+        std::shared_ptr<signal_node<S>> source,
+        const var_node<S>* input,
+        const window_t& window )
+        : window_node::signal_node( context )
+        , m_source( std::move( source ) )
+        , m_input( input )
+        , m_state( window )
+        , m_timer( m_state.timer() )
+    {
+        this->tracks_changed_predecessors = true;
+
+        record( m_source->value_ref() );
+        this->m_value = m_aggregator.result( m_values.size(), m_state );
+
+        react_graph& graph = window_node::get_graph();
+        if( m_input )
+        {
+            graph.add_admission_recorder();
+        }
+        graph.on_node_attach( *this, *m_source );
+        if( m_timer )
+        {
+            graph.on_node_attach( *this, *m_timer );
+        }
+    }
+
+    ~window_node() override
+    {
+        react_graph& graph = window_node::get_graph();
+        if( m_timer )
+        {
+            graph.on_node_detach( *this, *m_timer );
+        }
+        graph.on_node_detach( *this, *m_source );
+        if( m_input )
+        {
+            graph.remove_admission_recorder();
+        }
+    }
+
+    // Nodes can't be copied
+    window_node( const window_node& ) = delete;
+    window_node& operator=( const window_node& ) = delete;
+    window_node( window_node&& ) noexcept = delete;
+    window_node& operator=( window_node&& ) noexcept = delete;
+
+    void on_predecessor_changed( const reactive_node& predecessor ) override
+    {
+        if( &predecessor == m_source.get() )
+        {
+            m_source_changed = true;
+        }
+    }
+
+    // Called for other recorders too, so only admissions of the var source are recorded
+    bool on_predecessor_admitted( const reactive_node& predecessor ) override
+    {
+        if( m_input == nullptr || &predecessor != m_input )
+        {
+            return false;
+        }
+
+        record( m_input->admitted_value() );
+        m_admitted = true;
+        return true;
+    }
+
+    void tick() override
+    {
+        if( m_source_changed && !m_admitted )
+        {
+            record( m_source->value_ref() );
+        }
+        else
+        {
+            m_state.refresh();
+            evict();
+        }
+        m_source_changed = false;
+        m_admitted = false;
+
+        R new_value = m_aggregator.result( m_values.size(), m_state );
+        if( !equals( this->m_value, new_value ) )
+        {
+            this->m_value = std::move( new_value );
+            window_node::get_graph().on_node_pulse( *this );
+        }
+    }
+
+private:
+    void record( const S& value )
+    {
+        m_values.push_back( value );
+        m_state.on_push();
+        m_aggregator.push( value, m_next_seq++ );
+        evict();
+    }
+
+    void evict()
+    {
+        // The newest sample is never evicted
+        while( m_values.size() > 1 && m_state.should_evict( m_values.size() ) )
+        {
+            const std::uint64_t oldest_seq = m_next_seq - m_values.size();
+            m_aggregator.pop( m_values.front(), oldest_seq );
+            m_values.pop_front();
+            m_state.on_pop();
+        }
+
+        m_aggregator.maintain( m_values );
+    }
+
+    std::shared_ptr<signal_node<S>> m_source;
+
+    // The source if it is known to be a var, nullptr otherwise
+    const var_node<S>* m_input;
+
+    window_state<window_t> m_state;
+    std::shared_ptr<reactive_node> m_timer;
+    aggregator_t m_aggregator;
+    ring_buffer<S> m_values;
+    std::uint64_t m_next_seq = 0;
+
+    bool m_source_changed = false;
+    bool m_admitted = false;
+};
+
+template <typename R, typename aggregator_t, typename S, typename window_t>
+auto make_window_signal( const signal<S>& source, const window_t& window ) -> signal<R>
+{
+    context& context = source.get_context();
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return signal<R>( std::make_shared<window_node<S, R, aggregator_t, window_t>>(
+        context, get_node_ptr( source ), nullptr, window ) );
+}
+
+template <typename R, typename aggregator_t, typename S, typename window_t>
+auto make_window_signal( const var_signal<S>& source, const window_t& window ) -> signal<R>
+{
+    context& context = source.get_context();
+    const auto& node = get_node_ptr( source );
+
+    UREACT_ALLOC_SCOPE( node_creation );
+    return signal<R>( std::make_shared<window_node<S, R, aggregator_t, window_t>>(
+        context, node, static_cast<const var_node<S>*>( node.get() ), window ) );
+}
+
+} // namespace detail
+
+
+// Window signals of a var_signal source record a sample every time its value is set,
+// even if it is equal to the current one. Samples of other sources, including vars
+// passed as signal, are recorded on every change of the source
+
+/// Sum of the source values in the window
+template <typename S, typename window_t>
+auto window_sum( const signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S, detail::total_aggregator<S>>( source, window );
+}
+
+/// Sum of the var source values set during the window
+template <typename S, typename window_t>
+auto window_sum( const var_signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S, detail::total_aggregator<S>>( source, window );
+}
+
+/// Arithmetic mean of the source values in the window
+template <typename S, typename window_t>
+auto window_mean( const signal<S>& source, const window_t& window ) -> signal<double>
+{
+    return detail::make_window_signal<double, detail::mean_aggregator<S>>( source, window );
+}
+
+/// Arithmetic mean of the var source values set during the window
+template <typename S, typename window_t>
+auto window_mean( const var_signal<S>& source, const window_t& window ) -> signal<double>
+{
+    return detail::make_window_signal<double, detail::mean_aggregator<S>>( source, window );
+}
+
+/// Minimal source value in the window
+template <typename S, typename window_t>
+auto window_min( const signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S,
+        detail::extremum_aggregator<S, detail::strictly_less<S>>>( source, window );
+}
+
+/// Minimal var source value set during the window
+template <typename S, typename window_t>
+auto window_min( const var_signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S,
+        detail::extremum_aggregator<S, detail::strictly_less<S>>>( source, window );
+}
+
+/// Maximal source value in the window
+template <typename S, typename window_t>
+auto window_max( const signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S,
+        detail::extremum_aggregator<S, detail::strictly_greater<S>>>( source, window );
+}
+
+/// Maximal var source value set during the window
+template <typename S, typename window_t>
+auto window_max( const var_signal<S>& source, const window_t& window ) -> signal<S>
+{
+    return detail::make_window_signal<S,
+        detail::extremum_aggregator<S, detail::strictly_greater<S>>>( source, window );
+}
+
+/// Number of samples of the source per second during the time window
+template <typename S, typename clock_type>
+auto window_rate( const signal<S>& source, const time_window<clock_type>& window )
+    -> signal<double>
+{
+    return detail::make_window_signal<double, detail::rate_aggregator<S>>( source, window );
+}
+
+/// Number of values of the var source set per second during the time window
+template <typename S, typename clock_type>
+auto window_rate( const var_signal<S>& source, const time_window<clock_type>& window )
+    -> signal<double>
+{
+    return detail::make_window_signal<double, detail::rate_aggregator<S>>( source, window );
+}
+
+UREACT_END_NAMESPACE
+
+#endif // UREACT_WINDOW_H_
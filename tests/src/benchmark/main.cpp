@@ -0,0 +1,242 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "perf_counters.hpp"
+#include "tick_counter.hpp"
+#include "ureact/ureact.hpp"
+
+#ifdef UREACT_ENABLE_ALLOC_PROFILING
+#    include "ureact/alloc_profiler.hpp"
+
+UREACT_DEFINE_ALLOC_PROFILING_OPERATORS
+#endif
+
+namespace
+{
+
+/// Measures wall-clock time and hardware counters of the part of scenario after graph setup
+class measurement
+{
+public:
+    explicit measurement( perf_counters& counters )
+        : m_counters( counters )
+    {}
+
+    void start()
+    {
+        m_start = std::chrono::steady_clock::now();
+        m_counters.start();
+    }
+
+    void stop()
+    {
+        m_counters.stop();
+        m_elapsed = std::chrono::steady_clock::now() - m_start;
+    }
+
+    double elapsed_ns() const
+    {
+        return static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( m_elapsed ).count() );
+    }
+
+private:
+    perf_counters& m_counters;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::duration m_elapsed{};
+};
+
+struct scenario
+{
+    const char* name;
+    std::function<void( ureact::context&, int iterations, measurement& )> run;
+};
+
+// One input with many dependent nodes
+void fan_out( ureact::context& ctx, const int iterations, measurement& m )
+{
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    for( int i = 0; i < 100; ++i )
+    {
+        nodes.push_back( src + i );
+    }
+
+    m.start();
+    for( int i = 1; i <= iterations; ++i )
+    {
+        src <<= i;
+    }
+    m.stop();
+}
+
+// Long chain of dependent nodes
+void chain( ureact::context& ctx, const int iterations, measurement& m )
+{
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes{ src + 1 };
+    for( int i = 0; i < 100; ++i )
+    {
+        nodes.push_back( nodes.back() + 1 );
+    }
+
+    m.start();
+    for( int i = 1; i <= iterations; ++i )
+    {
+        src <<= i;
+    }
+    m.stop();
+}
+
+// Layers of nodes where each node depends on two nodes of the previous layer
+void grid( ureact::context& ctx, const int iterations, measurement& m )
+{
+    const int width = 10;
+    const int depth = 10;
+
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> layer( width, src );
+    for( int d = 0; d < depth; ++d )
+    {
+        std::vector<ureact::signal<int>> next;
+        for( int w = 0; w < width; ++w )
+        {
+            next.push_back( layer[w] + layer[( w + 1 ) % width] );
+        }
+        layer = next;
+    }
+
+    m.start();
+    for( int i = 1; i <= iterations; ++i )
+    {
+        src <<= i % 2;
+    }
+    m.stop();
+}
+
+// Many inputs changed in a single transaction with observers on top
+void transaction( ureact::context& ctx, const int iterations, measurement& m )
+{
+    std::vector<ureact::var_signal<int>> inputs;
+    std::vector<ureact::signal<int>> nodes;
+    std::uint64_t observed = 0;
+    for( int i = 0; i < 100; ++i )
+    {
+        inputs.push_back( make_var( ctx, 0 ) );
+        nodes.push_back( inputs.back() * 2 );
+        observe( nodes.back(), [&]( int /*v*/ ) { ++observed; } );
+    }
+
+    m.start();
+    for( int i = 1; i <= iterations; ++i )
+    {
+        ctx.do_transaction( [&] {
+            for( auto& input : inputs )
+            {
+                input <<= i;
+            }
+        } );
+    }
+    m.stop();
+}
+
+const scenario scenarios[] = {
+    { "fan_out", fan_out },
+    { "chain", chain },
+    { "grid", grid },
+    { "transaction", transaction },
+};
+
+} // namespace
+
+#ifdef UREACT_ENABLE_ALLOC_PROFILING
+
+// Report allocations per turn of each scenario
+int main( int argc, char** argv )
+{
+    const int iterations = argc > 1 ? std::atoi( argv[1] ) : 10000;
+
+    perf_counters counters;
+
+    for( const scenario& s : scenarios )
+    {
+        ureact::context ctx;
+        ureact::alloc_profiler allocs( ctx );
+        measurement m( counters );
+
+        s.run( ctx, iterations, m );
+
+        std::printf( "%s (%llu of %llu turns allocate)\n%s",
+            s.name,
+            static_cast<unsigned long long>( allocs.allocating_turns() ),
+            static_cast<unsigned long long>( allocs.turns() ),
+            allocs.report_text().c_str() );
+    }
+}
+
+#else
+
+// Report time and hardware counters per ticked node of each scenario
+int main( int argc, char** argv )
+{
+    const int iterations = argc > 1 ? std::atoi( argv[1] ) : 10000;
+
+    perf_counters counters;
+    if( !counters.any_available() )
+    {
+        std::printf( "perf_event counters are unavailable, only wall-clock time is measured\n" );
+    }
+
+    std::printf( "%-12s %12s %10s", "scenario", "nodes", "ns/node" );
+    for( int c = 0; c < perf_counters::counters_count; ++c )
+    {
+        std::printf( " %14s", perf_counters::name( c ) );
+    }
+    std::printf( "\n" );
+
+    for( const scenario& s : scenarios )
+    {
+        // Ticks are counted in a separate run, because listeners disable the fast paths
+        std::uint64_t ticks = 0;
+        {
+            ureact::context ctx;
+            tick_counter counter( ctx );
+            measurement m( counters );
+            s.run( ctx, iterations, m );
+            ticks = counter.ticks;
+        }
+
+        ureact::context ctx;
+        measurement m( counters );
+
+        s.run( ctx, iterations, m );
+
+        const double nodes = ticks != 0 ? static_cast<double>( ticks ) : 1.0;
+
+        std::printf( "%-12s %12llu %10.2f",
+            s.name,
+            static_cast<unsigned long long>( ticks ),
+            m.elapsed_ns() / nodes );
+        for( int c = 0; c < perf_counters::counters_count; ++c )
+        {
+            if( counters.available( c ) )
+            {
+                std::printf( " %14.2f", static_cast<double>( counters.value( c ) ) / nodes );
+            }
+            else
+            {
+                std::printf( " %14s", "n/a" );
+            }
+        }
+        std::printf( "\n" );
+    }
+}
+
+#endif
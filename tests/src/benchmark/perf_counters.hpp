@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined( __linux__ )
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+/// Hardware performance counters of the calling thread read via Linux perf_event.
+/// If perf_event is unavailable (other OS, no permissions, virtualized PMU), counters are
+/// reported as unavailable and measurement continues without them.
+class perf_counters
+{
+public:
+    enum counter
+    {
+        cycles,
+        instructions,
+        cache_misses,
+        branch_misses,
+        counters_count
+    };
+
+    static const char* name( const int counter )
+    {
+        static const char* names[counters_count]
+            = { "cycles", "instructions", "cache_misses", "branch_misses" };
+        return names[counter];
+    }
+
+    perf_counters()
+    {
+#if defined( __linux__ )
+        static const std::uint64_t configs[counters_count] = { PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES };
+
+        for( int i = 0; i < counters_count; ++i )
+        {
+            perf_event_attr attr;
+            std::memset( &attr, 0, sizeof( attr ) );
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof( attr );
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            m_fds[i] = static_cast<int>( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+        }
+#endif
+    }
+
+    perf_counters( const perf_counters& ) = delete;
+    perf_counters& operator=( const perf_counters& ) = delete;
+
+    ~perf_counters()
+    {
+#if defined( __linux__ )
+        for( const int fd : m_fds )
+        {
+            if( fd >= 0 )
+            {
+                close( fd );
+            }
+        }
+#endif
+    }
+
+    bool available( const int counter ) const
+    {
+        return m_fds[counter] >= 0;
+    }
+
+    bool any_available() const
+    {
+        for( int i = 0; i < counters_count; ++i )
+        {
+            if( available( i ) )
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start()
+    {
+#if defined( __linux__ )
+        for( const int fd : m_fds )
+        {
+            if( fd >= 0 )
+            {
+                ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+                ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+            }
+        }
+#endif
+    }
+
+    void stop()
+    {
+#if defined( __linux__ )
+        for( int i = 0; i < counters_count; ++i )
+        {
+            m_values[i] = 0;
+            if( m_fds[i] >= 0 )
+            {
+                ioctl( m_fds[i], PERF_EVENT_IOC_DISABLE, 0 );
+                if( read( m_fds[i], &m_values[i], sizeof( m_values[i] ) )
+                    != sizeof( m_values[i] ) )
+                {
+                    m_values[i] = 0;
+                }
+            }
+        }
+#endif
+    }
+
+    std::uint64_t value( const int counter ) const
+    {
+        return m_values[counter];
+    }
+
+private:
+    int m_fds[counters_count] = { -1, -1, -1, -1 };
+    std::uint64_t m_values[counters_count] = {};
+};
@@ -0,0 +1,166 @@
+#include <cstdint>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/alloc_profiler.hpp"
+#include "ureact/collection.hpp"
+#include "ureact/top_k.hpp"
+#include "ureact/window.hpp"
+
+UREACT_DEFINE_ALLOC_PROFILING_OPERATORS
+
+TEST_SUITE_BEGIN( "AllocProfilerTest" );
+
+TEST_CASE( "SubsystemTags" )
+{
+    using ureact::detail::alloc_subsystem;
+
+    const ureact::alloc_stats before = ureact::detail::recorded_allocations();
+
+    ureact::context ctx;
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> b = a * 2;
+    auto obs = observe( b, []( int /*v*/ ) {} );
+
+    const ureact::alloc_stats after = ureact::detail::recorded_allocations();
+
+    CHECK( after.count_of( alloc_subsystem::node_creation )
+           > before.count_of( alloc_subsystem::node_creation ) );
+    CHECK( after.count_of( alloc_subsystem::successors )
+           > before.count_of( alloc_subsystem::successors ) );
+    CHECK( after.count_of( alloc_subsystem::observer_registration )
+           > before.count_of( alloc_subsystem::observer_registration ) );
+    CHECK( after.bytes_of( alloc_subsystem::node_creation )
+           > before.bytes_of( alloc_subsystem::node_creation ) );
+
+    CHECK( ureact::detail::current_alloc_subsystem() == alloc_subsystem::user );
+}
+
+TEST_CASE( "ExtensionNodesAreTagged" )
+{
+    using ureact::detail::alloc_subsystem;
+
+    ureact::context ctx;
+    auto a = make_var( ctx, 1 );
+    auto records = ureact::make_collection<int, int>( ctx );
+
+    const auto node_creations = []() {
+        return ureact::detail::recorded_allocations().count_of( alloc_subsystem::node_creation );
+    };
+
+    std::uint64_t before = node_creations();
+    auto sum = window_sum( a, ureact::count_window( 4 ) );
+    CHECK( node_creations() > before );
+
+    before = node_creations();
+    auto top = top_k( std::vector<ureact::signal<int>>{ a }, 1, []( int v ) { return v; } );
+    CHECK( node_creations() > before );
+
+    before = node_creations();
+    auto counts = count( records );
+    CHECK( node_creations() > before );
+}
+
+TEST_CASE( "PerTurnAllocations" )
+{
+    using ureact::detail::alloc_subsystem;
+
+    ureact::context ctx;
+
+    auto src = make_var( ctx, std::string( "a" ) );
+    ureact::signal<std::string> longer
+        = make_signal( src, []( const std::string& s ) { return s + std::string( 100, 'x' ); } );
+    auto obs = observe( longer, []( const std::string& /*v*/ ) {} );
+
+    ureact::alloc_profiler profiler( ctx );
+
+    // New value is copied into the input before the turn is started. Result of the evaluation
+    // is moved, while allocations of the evaluation function itself are user ones
+    const std::string long_value( 100, 'b' );
+    src <<= long_value;
+    CHECK( profiler.turns() == 1 );
+    CHECK( profiler.outside_turns().count_of( alloc_subsystem::value_copy ) == 1 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::value_copy ) == 0 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::user ) > 0 );
+
+    // Queues keep their capacity, so only values allocate in the steady state
+    src <<= std::string( "c" );
+    CHECK( profiler.turns() == 2 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::scheduler_queue ) == 0 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::successors ) == 0 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::value_copy ) == 0 );
+    CHECK( profiler.last_turn().count_of( alloc_subsystem::user ) > 0 );
+    CHECK( profiler.total().count_of( alloc_subsystem::value_copy ) == 0 );
+
+    const std::string text = profiler.report_text();
+    CHECK( text.find( "value_copy: " ) != std::string::npos );
+    CHECK( text.find( "scheduler_queue: " ) != std::string::npos );
+
+    profiler.reset();
+    CHECK( profiler.turns() == 0 );
+    CHECK( profiler.total().internal_count() == 0 );
+}
+
+TEST_CASE( "AllocationsOutsideOfTurns" )
+{
+    using ureact::detail::alloc_subsystem;
+
+    ureact::context ctx;
+    auto a = make_var( ctx, 1 );
+
+    ureact::alloc_profiler profiler( ctx );
+
+    ureact::signal<int> b = a * 2;
+    auto obs = observe( b, []( int /*v*/ ) {} );
+
+    CHECK( profiler.outside_turns().count_of( alloc_subsystem::node_creation ) > 0 );
+    CHECK( profiler.outside_turns().count_of( alloc_subsystem::observer_registration ) > 0 );
+
+    const ureact::alloc_stats before_turn = profiler.outside_turns();
+
+    a <<= 2;
+
+    CHECK( profiler.turns() == 1 );
+    CHECK( profiler.total().count_of( alloc_subsystem::node_creation ) == 0 );
+    CHECK( profiler.total().count_of( alloc_subsystem::observer_registration ) == 0 );
+    CHECK( profiler.outside_turns().internal_count() == before_turn.internal_count() );
+
+    const std::string text = profiler.report_text();
+    CHECK( text.find( " bytes outside of turns\n" ) != std::string::npos );
+
+    profiler.reset();
+    CHECK( profiler.outside_turns().internal_count() == 0 );
+}
+
+TEST_CASE( "SteadyStateWithoutInternalAllocations" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+    ureact::signal<int> sum = a + b;
+    auto obs = observe( sum, []( int /*v*/ ) {} );
+
+    // Warm up queues
+    a <<= 2;
+    ctx.do_transaction( [&] {
+        a <<= 3;
+        b <<= 3;
+    } );
+
+    ureact::alloc_profiler profiler( ctx );
+
+    for( int i = 0; i < 10; ++i )
+    {
+        ctx.do_transaction( [&] {
+            a <<= 10 + i;
+            b <<= 20 + i;
+        } );
+    }
+
+    CHECK( profiler.turns() == 10 );
+    CHECK( profiler.allocating_turns() == 0 );
+}
+
+TEST_SUITE_END();
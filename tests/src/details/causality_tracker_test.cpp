@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/causality_tracker.hpp"
+
+TEST_SUITE_BEGIN( "CausalityTrackerTest" );
+
+TEST_CASE( "TriggeringInputs" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+    auto c = make_var( ctx, 1 );
+    ureact::signal<int> ab = a + b;
+    ureact::signal<int> clamped = make_signal( c, []( int v ) { return v > 10 ? 10 : v; } );
+    ureact::signal<int> result = ab + clamped;
+
+    auto obs = observe( result, []( int /*v*/ ) {} );
+
+    using ids = std::vector<ureact::detail::node_id_t>;
+
+    ureact::causality_tracker tracker( ctx, 2 );
+
+    a <<= 2;
+    const auto turn1 = ctx.current_turn();
+    CHECK( tracker.triggers( node_id( obs ), turn1 ) == ids{ node_id( a ) } );
+    CHECK( tracker.triggers( node_id( result ), turn1 ) == ids{ node_id( a ) } );
+
+    ctx.do_transaction( [&] {
+        b <<= 2;
+        c <<= 2;
+    } );
+    const auto turn2 = ctx.current_turn();
+
+    ids expected{ node_id( b ), node_id( c ) };
+    std::sort( expected.begin(), expected.end() );
+    ids actual = tracker.triggers( node_id( obs ), turn2 );
+    std::sort( actual.begin(), actual.end() );
+    CHECK( actual == expected );
+    CHECK( tracker.triggers( node_id( ab ), turn2 ) == ids{ node_id( b ) } );
+
+    // The second c change is stopped by clamped, so result isn't ticked
+    c <<= 20;
+    c <<= 30;
+    CHECK( tracker.triggers( node_id( obs ), ctx.current_turn() ).empty() );
+    CHECK( tracker.triggers( node_id( clamped ), ctx.current_turn() ) == ids{ node_id( c ) } );
+
+    // Out of history
+    CHECK( tracker.triggers( node_id( obs ), turn1 ).empty() );
+
+    b <<= 3;
+
+    const auto counts = tracker.trigger_counts( node_id( obs ) );
+    REQUIRE( counts.size() == 3 );
+    CHECK( counts[0].second == 2 );
+    CHECK( counts[1].second == 2 );
+    CHECK( counts[2].first == node_id( a ) );
+    CHECK( counts[2].second == 1 );
+
+    CHECK( tracker.trigger_counts( node_id( clamped ) ).front().second == 3 );
+
+    tracker.reset();
+    CHECK( tracker.trigger_counts( node_id( obs ) ).empty() );
+
+    // Inputs are indexed anew after reset
+    c <<= 5;
+    CHECK( tracker.triggers( node_id( obs ), ctx.current_turn() ) == ids{ node_id( c ) } );
+    CHECK( tracker.trigger_counts( node_id( obs ) ).size() == 1 );
+}
+
+TEST_SUITE_END();
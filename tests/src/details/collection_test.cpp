@@ -0,0 +1,258 @@
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <doctest.h>
+
+#include "ureact/collection.hpp"
+#include "ureact/ureact.hpp"
+
+namespace
+{
+
+// Multiset built by applying all deltas of a collection
+template <typename K, typename V>
+class materialized
+{
+public:
+    explicit materialized( const ureact::collection<K, V>& source )
+        : m_observer( observe( source, [this]( const ureact::collection_delta<K, V>& delta ) {
+            ++deltas;
+            for( const auto& change : delta.changes )
+            {
+                long& count = records[std::make_pair( change.key, change.value )];
+                count += change.diff;
+                if( count == 0 )
+                {
+                    records.erase( std::make_pair( change.key, change.value ) );
+                }
+            }
+        } ) )
+    {}
+
+    std::map<std::pair<K, V>, long> records;
+    int deltas = 0;
+
+private:
+    ureact::observer m_observer;
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN( "CollectionTest" );
+
+TEST_CASE( "Join" )
+{
+    ureact::context ctx;
+
+    auto positions = ureact::make_collection<std::string, int>( ctx );
+    auto prices = ureact::make_collection<std::string, double>( ctx );
+
+    auto joined = join( positions, prices );
+    materialized<std::string, std::pair<int, double>> result( joined );
+
+    positions.insert( "AAPL", 10 );
+    positions.insert( "MSFT", 5 );
+    CHECK( result.records.empty() );
+
+    prices.insert( "AAPL", 150.0 );
+    CHECK( result.records
+           == decltype( result.records ){ { { "AAPL", { 10, 150.0 } }, 1 } } );
+
+    // Update of a price is its erase and insert in one turn
+    ctx.do_transaction( [&] {
+        prices.erase( "AAPL", 150.0 );
+        prices.insert( "AAPL", 151.0 );
+        prices.insert( "MSFT", 300.0 );
+    } );
+    CHECK( result.records
+           == decltype( result.records ){
+               { { "AAPL", { 10, 151.0 } }, 1 }, { { "MSFT", { 5, 300.0 } }, 1 } } );
+
+    // Changes of both sides in one turn
+    ctx.do_transaction( [&] {
+        positions.insert( "GOOG", 2 );
+        prices.insert( "GOOG", 100.0 );
+        positions.erase( "MSFT", 5 );
+    } );
+    CHECK( result.records
+           == decltype( result.records ){
+               { { "AAPL", { 10, 151.0 } }, 1 }, { { "GOOG", { 2, 100.0 } }, 1 } } );
+
+    // Changes of a key without a match don't produce a delta
+    const int deltas = result.deltas;
+    positions.insert( "TSLA", 1 );
+    CHECK( result.deltas == deltas );
+
+    // Changes that cancel out in a transaction are passed through without consolidation
+    ctx.do_transaction( [&] {
+        prices.insert( "AAPL", 1.0 );
+        prices.erase( "AAPL", 1.0 );
+    } );
+    CHECK( result.deltas == deltas + 1 );
+    CHECK( joined.value().changes.size() == 2 );
+    CHECK( result.records.size() == 2 );
+}
+
+TEST_CASE( "SelfJoin" )
+{
+    ureact::context ctx;
+
+    auto edges = ureact::make_collection<int, int>( ctx );
+    materialized<int, std::pair<int, int>> result( join( edges, edges ) );
+
+    edges.insert( 1, 2 );
+    CHECK( result.records == decltype( result.records ){ { { 1, { 2, 2 } }, 1 } } );
+
+    edges.insert( 1, 3 );
+    CHECK( result.records
+           == decltype( result.records ){ { { 1, { 2, 2 } }, 1 },
+               { { 1, { 2, 3 } }, 1 },
+               { { 1, { 3, 2 } }, 1 },
+               { { 1, { 3, 3 } }, 1 } } );
+
+    edges.erase( 1, 2 );
+    CHECK( result.records == decltype( result.records ){ { { 1, { 3, 3 } }, 1 } } );
+}
+
+TEST_CASE( "GroupByCount" )
+{
+    ureact::context ctx;
+
+    // Trades keyed by id, valued by symbol
+    auto trades = ureact::make_collection<int, std::string>( ctx );
+
+    auto by_symbol
+        = group_by( trades, []( int /*id*/, const std::string& symbol ) { return symbol; } );
+    auto counts = count( by_symbol );
+    materialized<std::string, long> result( counts );
+
+    ctx.do_transaction( [&] {
+        trades.insert( 1, "AAPL" );
+        trades.insert( 2, "AAPL" );
+        trades.insert( 3, "MSFT" );
+    } );
+    CHECK( result.records
+           == decltype( result.records ){ { { "AAPL", 2 }, 1 }, { { "MSFT", 1 }, 1 } } );
+
+    // Only changed groups are retracted and reinserted
+    trades.insert( 4, "AAPL" );
+    CHECK( counts.value().changes.size() == 2 );
+    CHECK( result.records
+           == decltype( result.records ){ { { "AAPL", 3 }, 1 }, { { "MSFT", 1 }, 1 } } );
+
+    // Group disappears when its count drops to zero
+    trades.erase( 3, "MSFT" );
+    CHECK( counts.value().changes.size() == 1 );
+    CHECK( result.records == decltype( result.records ){ { { "AAPL", 3 }, 1 } } );
+
+    // Changes that don't affect counts don't produce a delta
+    const int deltas = result.deltas;
+    ctx.do_transaction( [&] {
+        trades.erase( 4, "AAPL" );
+        trades.insert( 5, "AAPL" );
+    } );
+    CHECK( result.deltas == deltas );
+
+    // Group that appears and disappears in one turn doesn't produce a delta
+    ctx.do_transaction( [&] {
+        trades.insert( 6, "GOOG" );
+        trades.erase( 6, "GOOG" );
+    } );
+    CHECK( result.deltas == deltas );
+
+    trades.insert( 7, "GOOG" );
+    CHECK( result.records
+           == decltype( result.records ){ { { "AAPL", 3 }, 1 }, { { "GOOG", 1 }, 1 } } );
+}
+
+TEST_CASE( "Size" )
+{
+    ureact::context ctx;
+
+    auto trades = ureact::make_collection<int, std::string>( ctx );
+    auto counts = count( trades );
+    CHECK( trades.value().size == 0 );
+    CHECK( counts.value().size == 0 );
+
+    ctx.do_transaction( [&] {
+        trades.insert( 1, "AAPL", 2 );
+        trades.insert( 2, "MSFT" );
+    } );
+    CHECK( trades.value().size == 3 );
+    CHECK( counts.value().size == 2 );
+
+    trades.erase( 1, "AAPL" );
+    CHECK( trades.value().size == 2 );
+    CHECK( counts.value().size == 2 );
+
+    trades.erase( 2, "MSFT" );
+    CHECK( trades.value().size == 1 );
+    CHECK( counts.value().size == 1 );
+}
+
+TEST_CASE( "OperatorOnNonEmptyCollection" )
+{
+    ureact::context ctx;
+
+    auto trades = ureact::make_collection<int, std::string>( ctx );
+    trades.insert( 1, "AAPL" );
+
+    CHECK_THROWS_AS( count( trades ), std::logic_error );
+
+    // Emptied collection can be used again
+    trades.erase( 1, "AAPL" );
+    auto counts = count( trades );
+    trades.insert( 2, "MSFT" );
+    CHECK( counts.value().size == 1 );
+}
+
+TEST_CASE( "UrgentChangeDuringTurn" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+    const ureact::detail::react_graph& graph = _get_internals( ctx ).get_graph();
+
+    auto items = ureact::make_collection<int, int>( ctx );
+    auto a = make_var( ctx, 0 );
+
+    // The join reads items at a higher level than the slow signal
+    auto by_key = group_by( items, []( int key, int /*value*/ ) { return key; } );
+    materialized<int, std::pair<int, int>> result( join( items, by_key ) );
+
+    std::atomic<bool> turn_started{ false };
+    ureact::signal<int> slow = make_signal( a, [&]( int v ) {
+        if( v == 1 )
+        {
+            turn_started = true;
+            while( !graph.has_pending_urgent_transactions() )
+            {
+                std::this_thread::yield();
+            }
+        }
+        return v;
+    } );
+
+    std::thread urgent( [&] {
+        while( !turn_started )
+        {
+            std::this_thread::yield();
+        }
+        ctx.do_transaction( ureact::turn_priority::urgent, [&] { items.insert( 2, 20 ); } );
+    } );
+
+    ctx.do_transaction( [&] {
+        items.insert( 1, 10 );
+        a <<= 1;
+    } );
+    urgent.join();
+
+    // The delta of the turn isn't replaced before the join reads it
+    CHECK( result.records
+           == decltype( result.records ){
+               { { 1, { 10, 10 } }, 1 }, { { 2, { 20, 20 } }, 1 } } );
+}
+
+TEST_SUITE_END();
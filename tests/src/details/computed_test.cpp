@@ -0,0 +1,175 @@
+#include <string>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "ComputedTest" );
+
+TEST_CASE( "TracksReadSignals" )
+{
+    ureact::context ctx;
+
+    auto use_first = make_var( ctx, true );
+    auto first = make_var( ctx, 1 );
+    auto second = make_var( ctx, 2 );
+
+    int evaluations = 0;
+    ureact::signal<int> result = computed( ctx, [&]( ureact::dependency_reader& read ) {
+        ++evaluations;
+        return read( use_first ) ? read( first ) : read( second );
+    } );
+
+    CHECK( result.value() == 1 );
+    CHECK( evaluations == 1 );
+
+    // Not read during the last evaluation
+    second <<= 20;
+    CHECK( evaluations == 1 );
+
+    first <<= 10;
+    CHECK( result.value() == 10 );
+    CHECK( evaluations == 2 );
+
+    use_first <<= false;
+    CHECK( result.value() == 20 );
+
+    const int before = evaluations;
+    first <<= 100;
+    CHECK( evaluations == before );
+
+    second <<= 200;
+    CHECK( result.value() == 200 );
+}
+
+TEST_CASE( "DeeperDependency" )
+{
+    ureact::context ctx;
+
+    auto cond = make_var( ctx, false );
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> deep = a * 2 + 1;
+
+    ureact::signal<int> result = computed(
+        ctx, [&]( ureact::dependency_reader& read ) { return read( cond ) ? read( deep ) : 0; } );
+    ureact::signal<std::string> text = result->*[]( int v ) { return std::to_string( v ); };
+
+    std::vector<int> values;
+    auto obs = observe( result, [&]( int v ) { values.push_back( v ); } );
+
+    // New dependency and its predecessor change in the same turn
+    ctx.do_transaction( [&] {
+        cond <<= true;
+        a <<= 5;
+    } );
+
+    CHECK( result.value() == 11 );
+    CHECK( text.value() == "11" );
+    CHECK( values == std::vector<int>{ 11 } );
+
+    a <<= 6;
+    CHECK( result.value() == 13 );
+    CHECK( text.value() == "13" );
+    CHECK( values == std::vector<int>{ 11, 13 } );
+}
+
+TEST_CASE( "ManyDependencies" )
+{
+    ureact::context ctx;
+
+    auto count = make_var( ctx, 10 );
+    std::vector<ureact::var_signal<int>> values;
+    for( int i = 0; i < 20; ++i )
+    {
+        values.push_back( make_var( ctx, i ) );
+    }
+
+    int evaluations = 0;
+    ureact::signal<int> sum = computed( ctx, [&]( ureact::dependency_reader& read ) {
+        ++evaluations;
+        int result = 0;
+        for( int i = 0; i < read( count ); ++i )
+        {
+            // Repeated reads of the same signal are one dependency
+            result += read( values[i] ) + read( values[i] ) - read( values[i] );
+        }
+        return result;
+    } );
+
+    CHECK( sum.value() == 45 );
+
+    values[3] <<= 103;
+    CHECK( sum.value() == 145 );
+
+    // Several dependencies are added at once
+    count <<= 20;
+    CHECK( sum.value() == 290 );
+
+    values[15] <<= 115;
+    CHECK( sum.value() == 390 );
+
+    // And removed at once
+    count <<= 5;
+    CHECK( sum.value() == 110 );
+
+    const int before = evaluations;
+    values[15] <<= 15;
+    CHECK( evaluations == before );
+
+    values[4] <<= 104;
+    CHECK( sum.value() == 210 );
+}
+
+TEST_CASE( "UntrackedReads" )
+{
+    ureact::context ctx;
+
+    auto tracked = make_var( ctx, 1 );
+    auto untracked = make_var( ctx, 10 );
+
+    ureact::signal<int> result = computed( ctx, [&]( ureact::dependency_reader& read ) {
+        return read( tracked ) + untracked.value();
+    } );
+
+    CHECK( result.value() == 11 );
+
+    // Read without the reader isn't a dependency
+    untracked <<= 20;
+    CHECK( result.value() == 11 );
+
+    tracked <<= 2;
+    CHECK( result.value() == 22 );
+}
+
+TEST_CASE( "NotDefaultConstructibleValue" )
+{
+    struct wrapped
+    {
+        explicit wrapped( int v )
+            : value( v )
+        {}
+
+        bool operator==( const wrapped& other ) const
+        {
+            return value == other.value;
+        }
+
+        int value;
+    };
+
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+
+    // Initial value is the result of the first evaluation
+    ureact::signal<wrapped> result = computed(
+        ctx, [&]( ureact::dependency_reader& read ) { return wrapped( read( a ) ); } );
+
+    CHECK( result.value().value == 1 );
+
+    a <<= 2;
+    CHECK( result.value().value == 2 );
+}
+
+TEST_SUITE_END();
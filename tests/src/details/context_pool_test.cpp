@@ -0,0 +1,177 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/context_pool.hpp"
+#include "ureact/ureact.hpp"
+
+namespace
+{
+
+struct session
+{
+    explicit session( ureact::context_pool& pool )
+        : ctx( pool )
+        , counter( make_var( ctx.get_context(), 0 ) )
+        , doubled( counter * 2 )
+    {}
+
+    ureact::pooled_context ctx;
+    ureact::var_signal<int> counter;
+    ureact::signal<int> doubled;
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN( "ContextPoolTest" );
+
+TEST_CASE( "SmallGraph" )
+{
+    // Per-context overhead stays small for pools with thousands of contexts.
+    // Rarely used state is allocated on demand, so the graph holds only its scheduler,
+    // input, observer and listener vectors and a few scalars
+    CHECK( sizeof( ureact::detail::react_graph )
+           <= sizeof( ureact::detail::topological_queue )
+                  + 3 * sizeof( std::vector<void*> ) + 4 * sizeof( std::uint64_t ) );
+}
+
+TEST_CASE( "ManyContexts" )
+{
+    ureact::context_pool pool( 4 );
+
+    const int sessions_count = 500;
+    const int posts = 20;
+
+    std::vector<std::unique_ptr<session>> sessions;
+    std::atomic<int> observed{ 0 };
+    std::vector<ureact::observer> observers;
+    for( int i = 0; i < sessions_count; ++i )
+    {
+        sessions.emplace_back( new session( pool ) );
+        observers.push_back( observe( sessions.back()->doubled, [&]( int ) { ++observed; } ) );
+    }
+
+    auto producer = [&]() {
+        for( int p = 0; p < posts; ++p )
+        {
+            for( auto& s : sessions )
+            {
+                session* ptr = s.get();
+                s->ctx.post( [ptr] { ptr->counter.modify( []( int& v ) { ++v; } ); } );
+            }
+        }
+    };
+
+    std::thread t1( producer );
+    std::thread t2( producer );
+    t1.join();
+    t2.join();
+
+    pool.wait_idle();
+
+    for( auto& s : sessions )
+    {
+        CHECK( s->counter.value() == 2 * posts );
+        CHECK( s->doubled.value() == 4 * posts );
+    }
+
+    // Pending functions are batched into transactions
+    CHECK( pool.transactions() <= static_cast<std::uint64_t>( sessions_count * posts * 2 ) );
+    CHECK( static_cast<std::uint64_t>( observed ) == pool.transactions() );
+
+    observers.clear();
+}
+
+TEST_CASE( "DestroyWithPendingFunctions" )
+{
+    ureact::context_pool pool( 1 );
+
+    std::atomic<int> performed{ 0 };
+    {
+        ureact::pooled_context ctx( pool );
+        for( int i = 0; i < 100; ++i )
+        {
+            ctx.post( [&] { ++performed; } );
+        }
+    }
+
+    pool.wait_idle();
+    CHECK( performed <= 100 );
+}
+
+TEST_CASE( "ThrowingFunction" )
+{
+    std::mutex mutex;
+    std::vector<std::string> errors;
+    ureact::context_pool pool( 2, [&]( std::exception_ptr error ) {
+        try
+        {
+            std::rethrow_exception( error );
+        }
+        catch( const std::runtime_error& e )
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            errors.emplace_back( e.what() );
+        }
+    } );
+
+    session s( pool );
+    session* ptr = &s;
+
+    s.ctx.post( [] { throw std::runtime_error( "failed" ); } );
+    s.ctx.post( [ptr] { ptr->counter <<= 1; } );
+    pool.wait_idle();
+
+    // Other functions of the transaction are still performed
+    CHECK( s.counter.value() == 1 );
+    CHECK( s.doubled.value() == 2 );
+
+    // Pool keeps working
+    s.ctx.post( [ptr] { ptr->counter <<= 2; } );
+    pool.wait_idle();
+    CHECK( s.doubled.value() == 4 );
+
+    std::lock_guard<std::mutex> lock( mutex );
+    CHECK( errors == std::vector<std::string>{ "failed" } );
+}
+
+TEST_CASE( "ThrowingObserver" )
+{
+    std::atomic<int> errors{ 0 };
+    ureact::context_pool pool( 2, [&]( std::exception_ptr /*error*/ ) { ++errors; } );
+
+    session s( pool );
+    session* ptr = &s;
+
+    std::vector<int> observed;
+    ureact::signal<int> tripled = s.counter * 3;
+    auto throwing = observe( s.doubled, []( int v ) {
+        if( v == 2 )
+        {
+            throw std::runtime_error( "observer failed" );
+        }
+    } );
+    auto obs = observe( tripled, [&]( int v ) { observed.push_back( v ); } );
+
+    s.ctx.post( [ptr] { ptr->counter <<= 1; } );
+    pool.wait_idle();
+    CHECK( errors == 1 );
+
+    // The context is not left in the middle of the failed turn
+    s.ctx.post( [ptr] { ptr->counter <<= 2; } );
+    pool.wait_idle();
+    CHECK( errors == 1 );
+    CHECK( s.doubled.value() == 4 );
+    CHECK( tripled.value() == 6 );
+    CHECK( !observed.empty() );
+    CHECK( observed.back() == 6 );
+}
+
+TEST_SUITE_END();
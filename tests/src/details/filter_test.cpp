@@ -0,0 +1,91 @@
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "FilterTest" );
+
+TEST_CASE( "Filter" )
+{
+    ureact::context ctx;
+
+    auto sensor = make_var( ctx, 10 );
+
+    int evaluations = 0;
+    ureact::signal<int> valid = filter( sensor, []( int v ) { return v >= 0 && v <= 100; } );
+    ureact::signal<int> scaled = valid->*[&]( int v ) {
+        ++evaluations;
+        return v * 2;
+    };
+
+    std::vector<int> values;
+    auto obs = observe( valid, [&]( int v ) { values.push_back( v ); } );
+
+    sensor <<= 20;
+    sensor <<= -5;
+    sensor <<= 1000;
+    sensor <<= 30;
+
+    CHECK( values == std::vector<int>{ 20, 30 } );
+    CHECK( scaled.value() == 60 );
+
+    // Out-of-band values cause no downstream work
+    CHECK( evaluations == 3 );
+}
+
+TEST_CASE( "InitialValue" )
+{
+    ureact::context ctx;
+
+    auto sensor = make_var( ctx, -5 );
+    const auto in_range = []( int v ) { return v >= 0 && v <= 100; };
+
+    // Current value of the source is taken even if it is rejected
+    ureact::signal<int> implicit = filter( sensor, in_range );
+    CHECK( implicit.value() == -5 );
+
+    ureact::signal<int> explicit_initial = filter( sensor, in_range, 0 );
+    CHECK( explicit_initial.value() == 0 );
+
+    sensor <<= 1000;
+    CHECK( implicit.value() == -5 );
+    CHECK( explicit_initial.value() == 0 );
+
+    sensor <<= 50;
+    CHECK( implicit.value() == 50 );
+    CHECK( explicit_initial.value() == 50 );
+}
+
+TEST_CASE( "Gate" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+    auto enable = make_var( ctx, true );
+
+    ureact::signal<int> gated = gate( src, enable );
+
+    std::vector<int> values;
+    auto obs = observe( gated, [&]( int v ) { values.push_back( v ); } );
+
+    src <<= 2;
+    enable <<= false;
+    src <<= 3;
+    src <<= 4;
+    CHECK( gated.value() == 2 );
+
+    // Reopened gate takes the current value
+    enable <<= true;
+    CHECK( gated.value() == 4 );
+
+    ctx.do_transaction( [&] {
+        src <<= 5;
+        enable <<= false;
+    } );
+    CHECK( gated.value() == 4 );
+
+    CHECK( values == std::vector<int>{ 2, 4 } );
+}
+
+TEST_SUITE_END();
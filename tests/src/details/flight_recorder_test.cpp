@@ -0,0 +1,197 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <doctest.h>
+
+#include "ureact/flight_recorder.hpp"
+#include "ureact/parallel_executor.hpp"
+
+TEST_SUITE_BEGIN( "FlightRecorderTest" );
+
+TEST_CASE( "RecordTurns" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+
+    ureact::signal<int> sum = a + b;
+    ureact::signal<int> product = a * b;
+
+    ureact::flight_recorder recorder( ctx, 8 );
+
+    CHECK( recorder.count() == 0 );
+
+    a <<= 2;
+
+    ctx.do_transaction( [&] {
+        a <<= 3;
+        b <<= 3;
+    } );
+
+    // Not changed value still makes a turn
+    b <<= 3;
+
+    const auto records = recorder.snapshot();
+    REQUIRE( records.size() == 3 );
+
+    CHECK( records[0].inputs_applied == 1 );
+    CHECK( records[0].nodes_ticked == 2 );
+
+    CHECK( records[1].turn_id == records[0].turn_id + 1 );
+    CHECK( records[1].inputs_applied == 2 );
+    CHECK( records[1].nodes_ticked == 2 );
+    CHECK( ( records[1].slowest_node == node_id( sum )
+             || records[1].slowest_node == node_id( product ) ) );
+
+    CHECK( records[2].inputs_applied == 0 );
+    CHECK( records[2].nodes_ticked == 0 );
+    CHECK( records[2].slowest_node == 0 );
+}
+
+TEST_CASE( "RingOverwrite" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> b = a * 2;
+
+    ureact::flight_recorder recorder( ctx, 4 );
+
+    for( int i = 1; i <= 10; ++i )
+    {
+        a <<= i;
+    }
+
+    CHECK( recorder.written() == 10 );
+    CHECK( recorder.count() == 4 );
+
+    const auto records = recorder.snapshot();
+    REQUIRE( records.size() == 4 );
+    for( size_t i = 1; i < records.size(); ++i )
+    {
+        CHECK( records[i].turn_id == records[i - 1].turn_id + 1 );
+    }
+    CHECK( records.back().turn_id == ctx.current_turn() );
+}
+
+TEST_CASE( "Dump" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> b = a * 2;
+
+    ureact::flight_recorder recorder( ctx, 4 );
+
+    a <<= 1;
+    a <<= 2;
+
+    std::FILE* file = std::tmpfile();
+    REQUIRE( file != nullptr );
+
+    CHECK( recorder.dump( file ) );
+
+    std::rewind( file );
+
+    ureact::flight_recorder::dump_header header{};
+    REQUIRE( std::fread( &header, sizeof( header ), 1, file ) == 1 );
+    CHECK( header.magic[0] == 'U' );
+    CHECK( header.record_size == sizeof( ureact::turn_record ) );
+    CHECK( header.count == 2 );
+
+    ureact::turn_record records[2];
+    REQUIRE( std::fread( records, sizeof( ureact::turn_record ), 2, file ) == 2 );
+    CHECK( records[1].slowest_node == node_id( b ) );
+
+    std::fclose( file );
+}
+
+TEST_CASE( "WriteDumpWrapped" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> b = a * 2;
+
+    ureact::flight_recorder recorder( ctx, 4 );
+
+    for( int i = 1; i <= 6; ++i )
+    {
+        a <<= i;
+    }
+
+    std::FILE* file = std::tmpfile();
+    REQUIRE( file != nullptr );
+
+    CHECK( recorder.write_dump( fileno( file ) ) );
+
+    std::rewind( file );
+
+    ureact::flight_recorder::dump_header header{};
+    REQUIRE( std::fread( &header, sizeof( header ), 1, file ) == 1 );
+    CHECK( header.count == 4 );
+
+    // Records are ordered from the oldest to the newest despite the ring wrap
+    const auto expected = recorder.snapshot();
+    ureact::turn_record records[4];
+    REQUIRE( std::fread( records, sizeof( ureact::turn_record ), 4, file ) == 4 );
+    for( int i = 0; i < 4; ++i )
+    {
+        CHECK( records[i].turn_id == expected[i].turn_id );
+    }
+
+    std::fclose( file );
+}
+
+TEST_CASE( "SlowestNodeDestroyedDuringTurn" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> slow = make_signal( a, []( int v ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        return v;
+    } );
+    const auto slow_id = node_id( slow );
+
+    // Observer is ticked after the slow node and destroys it
+    ureact::observer obs = observe( a, [&]( int /*v*/ ) { slow = ureact::signal<int>(); } );
+
+    ureact::flight_recorder recorder( ctx, 4 );
+
+    a <<= 1;
+
+    REQUIRE( recorder.count() == 1 );
+    CHECK( recorder.snapshot()[0].slowest_node == slow_id );
+}
+
+TEST_CASE( "FastPathsStayEnabled" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 2;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    ureact::flight_recorder recorder( ctx, 4 );
+
+    auto src = make_var( ctx, 0 );
+    ureact::signal<int> a = src + 1;
+    ureact::signal<int> b = src + 2;
+
+    std::atomic<int> sum{ 0 };
+    ureact::observer obs_a = observe( a, [&]( int v ) { sum += v; } );
+    ureact::observer obs_b = observe( b, [&]( int v ) { sum += v; } );
+
+    src <<= 1;
+
+    CHECK( sum == 5 );
+    CHECK( phase.parallel_phases() == 1 );
+    REQUIRE( recorder.count() == 1 );
+    CHECK( recorder.snapshot()[0].inputs_applied == 1 );
+}
+
+TEST_SUITE_END();
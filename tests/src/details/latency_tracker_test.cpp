@@ -0,0 +1,131 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <doctest.h>
+
+#include "ureact/latency_tracker.hpp"
+#include "ureact/parallel_executor.hpp"
+
+TEST_SUITE_BEGIN( "LatencyTrackerTest" );
+
+TEST_CASE( "InputToObserverLatency" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+    ureact::signal<int> sum = a + b;
+    ureact::signal<int> twice = b * 2;
+
+    auto sum_obs = observe( sum, []( int /*v*/ ) {} );
+    auto twice_obs = observe( twice, []( int /*v*/ ) {} );
+    set_debug_name( sum_obs, "sum_obs" );
+
+    ureact::latency_tracker tracker( ctx );
+
+    a <<= 2;
+
+    CHECK( tracker.latency().count() == 1 );
+    REQUIRE( tracker.per_observer().count( node_id( sum_obs ) ) == 1 );
+    CHECK( tracker.per_observer().at( node_id( sum_obs ) ).name == "sum_obs" );
+    CHECK( tracker.per_observer().at( node_id( sum_obs ) ).count == 1 );
+
+    // Time spent in transaction function is counted from the oldest changed input
+    const auto delay = std::chrono::milliseconds( 5 );
+    ctx.do_transaction( [&] {
+        b <<= 2;
+        std::this_thread::sleep_for( delay );
+        a <<= 3;
+    } );
+
+    CHECK( tracker.latency().count() == 3 );
+
+    const auto& sum_stats = tracker.per_observer().at( node_id( sum_obs ) );
+    CHECK( sum_stats.count == 2 );
+    CHECK( sum_stats.max >= static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>( delay ).count() ) );
+
+    const auto& twice_stats = tracker.per_observer().at( node_id( twice_obs ) );
+    CHECK( twice_stats.count == 1 );
+    CHECK( twice_stats.max >= static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>( delay ).count() ) );
+
+    // Unchanged input doesn't affect the next turns
+    ctx.do_transaction( [&] {
+        a <<= 3;
+        std::this_thread::sleep_for( delay );
+    } );
+    a <<= 4;
+
+    CHECK( tracker.per_observer().at( node_id( sum_obs ) ).count == 3 );
+
+    tracker.reset();
+    CHECK( tracker.latency().count() == 0 );
+    CHECK( tracker.per_observer().empty() );
+}
+
+TEST_CASE( "QueueingTime" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+    ureact::signal<int> twice = b * 2;
+    auto twice_obs = observe( twice, []( int /*v*/ ) {} );
+
+    ureact::latency_tracker tracker( ctx );
+
+    // Input is set while another thread holds the graph lock, waiting time is counted
+    const auto delay = std::chrono::milliseconds( 20 );
+    std::atomic<bool> locked{ false };
+    std::thread writer( [&] {
+        while( !locked )
+        {
+            std::this_thread::yield();
+        }
+        b <<= 2;
+    } );
+
+    ctx.do_transaction( [&] {
+        a <<= 2;
+        locked = true;
+        std::this_thread::sleep_for( delay );
+    } );
+
+    writer.join();
+
+    REQUIRE( tracker.per_observer().count( node_id( twice_obs ) ) == 1 );
+    CHECK( tracker.per_observer().at( node_id( twice_obs ) ).max
+           >= static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>( delay / 2 ).count() ) );
+}
+
+TEST_CASE( "TrackerKeepsObserverPhaseEnabled" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 2;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    ureact::latency_tracker tracker( ctx );
+
+    auto src = make_var( ctx, 0 );
+    ureact::signal<int> a = src + 1;
+    ureact::signal<int> b = src + 2;
+
+    std::atomic<int> sum{ 0 };
+    ureact::observer obs_a = observe( a, [&]( int v ) { sum += v; } );
+    ureact::observer obs_b = observe( b, [&]( int v ) { sum += v; } );
+
+    src <<= 1;
+
+    CHECK( sum == 5 );
+    CHECK( phase.parallel_phases() == 1 );
+    CHECK( tracker.latency().count() == 2 );
+    CHECK( tracker.per_observer().count( node_id( obs_a ) ) == 1 );
+    CHECK( tracker.per_observer().count( node_id( obs_b ) ) == 1 );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/parallel_executor.hpp"
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "ObserverPhaseTest" );
+
+TEST_CASE( "ObserversAreInvokedAfterPropagation" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 3;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    std::vector<ureact::observer> observers;
+    std::atomic<int> sum{ 0 };
+    std::atomic<int> last_total{ 0 };
+
+    for( int i = 0; i < 8; ++i )
+    {
+        nodes.push_back( src + i );
+    }
+    ureact::signal<int> total = nodes[0] + nodes[7];
+
+    for( int i = 0; i < 8; ++i )
+    {
+        observers.push_back( observe( nodes[i], [&]( int v ) {
+            sum += v;
+            // All nodes have final values when observers are invoked
+            last_total = total.value();
+        } ) );
+    }
+
+    src <<= 1;
+
+    CHECK( sum == 8 + 28 );
+    CHECK( last_total == 9 );
+    CHECK( phase.parallel_phases() == 1 );
+}
+
+TEST_CASE( "SameSubjectSerial" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 3;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+
+    std::vector<int> order;
+    std::atomic<int> b_count{ 0 };
+    auto obs1 = observe( a, [&]( int /*v*/ ) { order.push_back( 1 ); } );
+    auto obs2 = observe( b, [&]( int /*v*/ ) { ++b_count; } );
+    auto obs3 = observe( a, [&]( int /*v*/ ) { order.push_back( 3 ); } );
+
+    for( int i = 1; i <= 10; ++i )
+    {
+        ctx.do_transaction( [&] {
+            a <<= i;
+            b <<= i;
+        } );
+    }
+
+    CHECK( b_count == 10 );
+    REQUIRE( order.size() == 20 );
+    for( size_t i = 0; i < order.size(); i += 2 )
+    {
+        CHECK( order[i] == 1 );
+        CHECK( order[i + 1] == 3 );
+    }
+}
+
+TEST_CASE( "DetachAfterPhase" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 2;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    auto a = make_var( ctx, 0 );
+
+    std::atomic<int> once_count{ 0 };
+    std::atomic<int> always_count{ 0 };
+    auto once = observe( a, [&]( int /*v*/ ) {
+        ++once_count;
+        return ureact::observer_action::stop_and_detach;
+    } );
+    auto always = observe( a, [&]( int /*v*/ ) { ++always_count; } );
+
+    a <<= 1;
+    a <<= 2;
+
+    CHECK( once_count == 1 );
+    CHECK( always_count == 2 );
+}
+
+TEST_CASE( "SerialObserversCanChangeInputs" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 1;
+    options.min_parallel_observers = 100;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+
+    std::vector<int> b_values;
+    auto obs_a = observe( a, [&]( int v ) { b <<= v * 10; } );
+    auto obs_b = observe( b, [&]( int v ) { b_values.push_back( v ); } );
+
+    a <<= 1;
+    a <<= 2;
+
+    CHECK( b_values == std::vector<int>{ 10, 20 } );
+    CHECK( phase.parallel_phases() == 0 );
+}
+
+TEST_SUITE_END();
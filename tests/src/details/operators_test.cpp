@@ -1,5 +1,6 @@
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <doctest.h>
 
@@ -407,4 +408,45 @@ TEST_SUITE( "operators" )
         CHECK( result2.value() == 8 );
     }
 
+    TEST_CASE( "operator chains are folded" )
+    {
+        ureact::context ctx;
+
+        auto a = make_var( ctx, 1 );
+        auto b = make_var( ctx, 10 );
+        auto c = make_var( ctx, 100 );
+        auto d = make_var( ctx, 1000 );
+
+        // The type of a chain doesn't depend on its length. Two operands aren't folded
+        auto sum2 = a + b;
+        auto sum3 = a + b + c;
+        auto sum4 = a + b + c + d;
+        static_assert( std::is_same<decltype( sum3 ), decltype( sum4 )>::value,
+            "Chains of the same operator over the same type should be folded" );
+        static_assert( !std::is_same<decltype( sum2 ), decltype( sum3 )>::value,
+            "Binary operations should stay function_op" );
+
+        // Folding keeps left associativity
+        ureact::signal<int> diff = a - b - c - d;
+        ureact::signal<int> sum = std::move( sum4 );
+
+        // Folded op nested into other ops
+        ureact::signal<int> scaled = ( a + b + c ) * 2;
+        ureact::signal<int> mixed = -( a + b + c ) + d;
+
+        CHECK( sum2.value() == 11 );
+        CHECK( sum3.value() == 111 );
+        CHECK( sum.value() == 1111 );
+        CHECK( diff.value() == 1 - 10 - 100 - 1000 );
+        CHECK( scaled.value() == 222 );
+        CHECK( mixed.value() == 889 );
+
+        c <<= 200;
+
+        CHECK( sum.value() == 1211 );
+        CHECK( diff.value() == 1 - 10 - 200 - 1000 );
+        CHECK( scaled.value() == 422 );
+        CHECK( mixed.value() == 789 );
+    }
+
 } // TEST_SUITE_END
@@ -0,0 +1,224 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/parallel_executor.hpp"
+#include "ureact/ureact.hpp"
+
+namespace
+{
+
+int slow_add( int v, int i )
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds( 50 );
+    while( std::chrono::steady_clock::now() < until )
+    {
+    }
+    return v + i;
+}
+
+} // namespace
+
+TEST_SUITE_BEGIN( "ParallelExecutorTest" );
+
+TEST_CASE( "CheapLevelsAreTickedSerially" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+    ureact::parallel_executor executor( ctx );
+
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    for( int i = 0; i < 100; ++i )
+    {
+        nodes.push_back( src + i );
+    }
+
+    for( int i = 1; i <= 100; ++i )
+    {
+        src <<= i;
+    }
+
+    for( int i = 0; i < 100; ++i )
+    {
+        CHECK( nodes[i].value() == 100 + i );
+    }
+
+    CHECK( executor.forked_levels() == 0 );
+    CHECK( executor.serial_levels() == 100 );
+}
+
+TEST_CASE( "ExpensiveLevelsAreForked" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_executor_options options;
+    options.workers = 3;
+    ureact::parallel_executor executor( ctx, options );
+
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    std::vector<ureact::signal<int>> cheap;
+    for( int i = 0; i < 8; ++i )
+    {
+        nodes.push_back( make_signal( src, ureact::parallel_safe( [i]( int v ) {
+            return slow_add( v, i );
+        } ) ) );
+    }
+    for( int i = 0; i < 100; ++i )
+    {
+        cheap.push_back( src + i );
+    }
+    ureact::signal<int> total = nodes[0] + nodes[7];
+
+    int observed = 0;
+    auto obs = observe( total, [&]( int /*v*/ ) { ++observed; } );
+
+    for( int i = 1; i <= 20; ++i )
+    {
+        src <<= i;
+
+        for( int n = 0; n < 8; ++n )
+        {
+            CHECK( nodes[n].value() == i + n );
+        }
+        CHECK( cheap[99].value() == i + 99 );
+        CHECK( total.value() == 2 * i + 7 );
+    }
+
+    CHECK( observed == 20 );
+
+    // The first level is measured, then it is forked
+    CHECK( executor.forked_levels() > 0 );
+
+    // Cheap nodes are packed together with expensive ones
+    CHECK( executor.tasks() < executor.forked_levels() * 108 );
+}
+
+TEST_CASE( "Exceptions" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_executor_options options;
+    options.workers = 2;
+    options.fork_threshold_ns = 1.0f;
+    options.min_task_ns = 1.0f;
+    ureact::parallel_executor executor( ctx, options );
+
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    for( int i = 0; i < 4; ++i )
+    {
+        nodes.push_back( make_signal( src, ureact::parallel_safe( [i]( int v ) {
+            if( v == 3 && i == 2 )
+            {
+                throw std::runtime_error( "fail" );
+            }
+            return v + i;
+        } ) ) );
+    }
+
+    src <<= 1;
+    src <<= 2;
+
+    CHECK_THROWS_AS( src <<= 3, std::runtime_error );
+
+    // Graph is restored after the failed turn
+    src <<= 4;
+    CHECK( nodes[0].value() == 4 );
+    CHECK( nodes[3].value() == 7 );
+}
+
+TEST_CASE( "UnmarkedFunctionsStayOnPropagatingThread" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_executor_options options;
+    options.workers = 2;
+    options.fork_threshold_ns = 1.0f;
+    options.min_task_ns = 1.0f;
+    ureact::parallel_executor executor( ctx, options );
+
+    auto src = make_var( ctx, 0 );
+
+    const std::thread::id propagating = std::this_thread::get_id();
+    std::atomic<int> foreign_calls{ 0 };
+
+    std::vector<ureact::signal<int>> nodes;
+    std::vector<ureact::signal<int>> filtered;
+    for( int i = 0; i < 4; ++i )
+    {
+        nodes.push_back( make_signal( src, [&, i]( int v ) {
+            if( std::this_thread::get_id() != propagating )
+            {
+                ++foreign_calls;
+            }
+            return slow_add( v, i );
+        } ) );
+        filtered.push_back( filter( src, [&]( int /*v*/ ) {
+            if( std::this_thread::get_id() != propagating )
+            {
+                ++foreign_calls;
+            }
+            return true;
+        } ) );
+        nodes.push_back( make_signal( src, ureact::parallel_safe( [i]( int v ) {
+            return slow_add( v, i );
+        } ) ) );
+    }
+
+    for( int i = 1; i <= 10; ++i )
+    {
+        src <<= i;
+    }
+
+    CHECK( executor.forked_levels() > 0 );
+    CHECK( foreign_calls == 0 );
+    CHECK( nodes[0].value() == 10 );
+    CHECK( filtered[0].value() == 10 );
+}
+
+TEST_CASE( "NestedTurnsAreTickedSerially" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_executor_options options;
+    options.workers = 2;
+    options.fork_threshold_ns = 1.0f;
+    options.min_task_ns = 1.0f;
+    ureact::parallel_executor executor( ctx, options );
+
+    auto trigger = make_var( ctx, 0 );
+    auto src = make_var( ctx, 0 );
+
+    std::vector<ureact::signal<int>> nodes;
+    for( int i = 0; i < 4; ++i )
+    {
+        nodes.push_back( make_signal( trigger, ureact::parallel_safe( [i]( int v ) {
+            return slow_add( v, i );
+        } ) ) );
+        nodes.push_back( make_signal( src, ureact::parallel_safe( [i]( int v ) {
+            return slow_add( v, i );
+        } ) ) );
+    }
+
+    // Observer is ticked by the executor and starts a nested turn
+    auto obs = observe( nodes[0], [&]( int v ) { src <<= v; } );
+
+    for( int i = 1; i <= 10; ++i )
+    {
+        trigger <<= i;
+        CHECK( nodes[1].value() == i );
+        CHECK( nodes[7].value() == i + 3 );
+    }
+
+    CHECK( executor.forked_levels() > 0 );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <doctest.h>
+
+#include "ureact/parallelism_analyzer.hpp"
+
+TEST_SUITE_BEGIN( "ParallelismAnalyzerTest" );
+
+TEST_CASE( "CriticalPath" )
+{
+    ureact::context ctx;
+
+    //    a     b   //
+    //   / \    |   //
+    //  x   y   w   //
+    //   \ /        //
+    //    z         //
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+    ureact::signal<int> x = a + 1;
+    ureact::signal<int> y = a + 2;
+    ureact::signal<int> z = x + y;
+    ureact::signal<int> w = b * 2;
+
+    set_debug_name( a, "a" );
+    set_debug_name( b, "b" );
+
+    ureact::parallelism_analyzer analyzer( ctx );
+    analyzer.set_node_cost( node_id( x ), 10 );
+    analyzer.set_node_cost( node_id( y ), 30 );
+    analyzer.set_node_cost( node_id( z ), 5 );
+    analyzer.set_node_cost( node_id( w ), 7 );
+
+    a <<= 2;
+    a <<= 3;
+    b <<= 2;
+    ctx.do_transaction( [&] {
+        a <<= 4;
+        b <<= 4;
+    } );
+
+    const auto report = analyzer.report();
+    REQUIRE( report.size() == 3 );
+
+    const auto& a_type = report[0];
+    CHECK( a_type.turns == 2 );
+    CHECK( a_type.input_names == std::vector<std::string>{ "a" } );
+    CHECK( a_type.total_work == doctest::Approx( 45 ) );
+    CHECK( a_type.critical_path == doctest::Approx( 35 ) );
+    REQUIRE( a_type.level_work.size() == 3 );
+    CHECK( a_type.level_work[0] == doctest::Approx( 0 ) );
+    CHECK( a_type.level_work[1] == doctest::Approx( 40 ) );
+    CHECK( a_type.level_work[2] == doctest::Approx( 5 ) );
+    CHECK( a_type.ideal_speedup( 1 ) == doctest::Approx( 1 ) );
+    CHECK( a_type.ideal_speedup( 2 ) == doctest::Approx( 45.0 / 35.0 ) );
+    CHECK( a_type.level_speedup( 2 ) == doctest::Approx( 45.0 / 35.0 ) );
+
+    const auto& b_type = report[1].inputs.size() == 1 ? report[1] : report[2];
+    CHECK( b_type.inputs == std::vector<ureact::detail::node_id_t>{ node_id( b ) } );
+    CHECK( b_type.critical_path == doctest::Approx( 7 ) );
+    CHECK( b_type.ideal_speedup( 4 ) == doctest::Approx( 1 ) );
+
+    const auto& ab_type = report[1].inputs.size() == 2 ? report[1] : report[2];
+    CHECK( ab_type.total_work == doctest::Approx( 52 ) );
+    CHECK( ab_type.critical_path == doctest::Approx( 35 ) );
+    CHECK( ab_type.level_work[1] == doctest::Approx( 47 ) );
+    CHECK( ab_type.ideal_speedup( 8 ) == doctest::Approx( 52.0 / 35.0 ) );
+    CHECK( ab_type.level_speedup( 8 ) == doctest::Approx( 52.0 / 35.0 ) );
+
+    const std::string text = analyzer.report_text( { 2 } );
+    CHECK( text.find( "inputs: a\n  turns: 2\n" ) != std::string::npos );
+    CHECK( text.find( "speedup x2: ideal " ) != std::string::npos );
+}
+
+TEST_CASE( "InputAppliedTwice" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> x = a + 1;
+
+    // Observer changes the input again, so it is applied twice in a single turn
+    ureact::observer obs = observe( x, [&]( int v ) {
+        if( v == 3 )
+        {
+            a <<= 10;
+        }
+    } );
+
+    ureact::parallelism_analyzer analyzer( ctx );
+
+    a <<= 2;
+    CHECK( x.value() == 11 );
+
+    const auto report = analyzer.report();
+    REQUIRE( report.size() == 1 );
+    CHECK( report[0].inputs == std::vector<ureact::detail::node_id_t>{ node_id( a ) } );
+}
+
+TEST_CASE( "NestedTicks" )
+{
+    ureact::context ctx;
+
+    auto trigger = make_var( ctx, 0 );
+    auto src = make_var( ctx, 0 );
+
+    const auto delay = std::chrono::milliseconds( 2 );
+    ureact::signal<int> slow = make_signal( src, [&]( int v ) {
+        std::this_thread::sleep_for( delay );
+        return v;
+    } );
+    ureact::signal<int> fast = slow + 1;
+
+    ureact::parallelism_analyzer analyzer( ctx );
+
+    // Ticks of the nested turn are made inside of the observer's tick
+    ureact::observer obs = observe( trigger, [&]( int v ) { src <<= v; } );
+
+    trigger <<= 1;
+
+    const auto report = analyzer.report();
+    REQUIRE( report.size() == 1 );
+
+    // Slow node is counted both on its own and as a part of the observer
+    const auto delay_ns = std::chrono::duration_cast<std::chrono::nanoseconds>( delay ).count();
+    CHECK( report[0].total_work >= 2.0 * static_cast<double>( delay_ns ) );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,80 @@
+#include <string>
+
+#include <doctest.h>
+
+#include "ureact/path_profiler.hpp"
+
+TEST_SUITE_BEGIN( "PathProfilerTest" );
+
+TEST_CASE( "FoldedStacks" )
+{
+    ureact::context ctx;
+
+    auto price = make_var( ctx, 1 );
+    auto volume = make_var( ctx, 1 );
+    ureact::signal<int> spread = price * 2;
+    ureact::signal<int> total = spread * volume;
+
+    set_debug_name( price, "price" );
+    set_debug_name( volume, "volume" );
+    set_debug_name( spread, "spread" );
+    set_debug_name( total, "total" );
+
+    auto obs = observe( total, []( int /*v*/ ) {} );
+    set_debug_name( obs, "printer" );
+
+    ureact::path_profiler profiler( ctx );
+
+    price <<= 2;
+    volume <<= 2;
+
+    const auto stacks = profiler.stacks();
+    CHECK( stacks.size() == 5 );
+    CHECK( stacks.count( "price;spread" ) == 1 );
+    CHECK( stacks.count( "price;spread;total" ) == 1 );
+    CHECK( stacks.count( "price;spread;total;printer" ) == 1 );
+    CHECK( stacks.count( "volume;total" ) == 1 );
+    CHECK( stacks.count( "volume;total;printer" ) == 1 );
+
+    const std::string folded = profiler.folded();
+    CHECK( folded.find( "volume;total;printer " ) != std::string::npos );
+    CHECK( folded.back() == '\n' );
+
+    profiler.reset();
+    CHECK( profiler.stacks().empty() );
+}
+
+TEST_CASE( "UnnamedNodes" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> b = a + 1;
+
+    ureact::path_profiler profiler( ctx );
+
+    a <<= 2;
+
+    const std::string expected
+        = "#" + std::to_string( node_id( a ) ) + ";#" + std::to_string( node_id( b ) );
+    CHECK( profiler.stacks().count( expected ) == 1 );
+}
+
+TEST_CASE( "EscapedNames" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> b = a + 1;
+
+    set_debug_name( a, "best bid;ask" );
+    set_debug_name( b, "mid" );
+
+    ureact::path_profiler profiler( ctx );
+
+    a <<= 2;
+
+    CHECK( profiler.folded().find( "best_bid_ask;mid " ) == 0 );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,233 @@
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "PriorityTest" );
+
+TEST_CASE( "UrgentTransactionIsMergedIntoRunningTurn" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+
+    std::atomic<bool> turn_started{ false };
+    const ureact::detail::react_graph& graph = _get_internals( ctx ).get_graph();
+
+    ureact::signal<int> slow = make_signal( a, [&]( int v ) {
+        if( v == 1 )
+        {
+            turn_started = true;
+            // Wait until urgent transaction is queued
+            while( !graph.has_pending_urgent_transactions() )
+            {
+                std::this_thread::yield();
+            }
+        }
+        return v;
+    } );
+    ureact::signal<int> sum = slow + b;
+
+    std::vector<int> results;
+    auto obs = observe( sum, [&]( int v ) { results.push_back( v ); } );
+
+    std::thread urgent( [&] {
+        while( !turn_started )
+        {
+            std::this_thread::yield();
+        }
+        ctx.do_transaction( ureact::turn_priority::urgent, [&] { b <<= 10; } );
+
+        // Inputs are applied when urgent transaction returns
+        CHECK( b.value() == 10 );
+    } );
+
+    a <<= 1;
+    urgent.join();
+
+    // Both changes are propagated in the same turn
+    CHECK( results == std::vector<int>{ 11 } );
+}
+
+TEST_CASE( "ThrowingUrgentTransaction" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+    const ureact::detail::react_graph& graph = _get_internals( ctx ).get_graph();
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+
+    std::atomic<bool> turn_started{ false };
+
+    ureact::signal<int> slow = make_signal( a, [&]( int v ) {
+        if( v == 1 )
+        {
+            turn_started = true;
+            while( !graph.has_pending_urgent_transactions() )
+            {
+                std::this_thread::yield();
+            }
+        }
+        return v;
+    } );
+    ureact::signal<int> sum = slow + b;
+
+    bool thrown = false;
+    std::thread urgent( [&] {
+        while( !turn_started )
+        {
+            std::this_thread::yield();
+        }
+        try
+        {
+            ctx.do_transaction( ureact::turn_priority::urgent, [&] {
+                b <<= 10;
+                throw std::runtime_error( "failed" );
+            } );
+        }
+        catch( const std::runtime_error& )
+        {
+            thrown = true;
+        }
+    } );
+
+    a <<= 1;
+    urgent.join();
+
+    // Exception is rethrown to the submitter, the turn finishes normally
+    CHECK( thrown );
+    CHECK( sum.value() == 11 );
+
+    // Transaction level is restored, so the next change is propagated right away
+    a <<= 2;
+    CHECK( sum.value() == 12 );
+}
+
+TEST_CASE( "ThrowingTurnFailsUrgentTransactions" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+    const ureact::detail::react_graph& graph = _get_internals( ctx ).get_graph();
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+    ureact::signal<int> sum = a + b;
+
+    std::atomic<bool> turn_started{ false };
+    auto throwing = observe( a, [&]( int v ) {
+        if( v == 1 )
+        {
+            turn_started = true;
+            while( !graph.has_pending_urgent_transactions() )
+            {
+                std::this_thread::yield();
+            }
+            throw std::runtime_error( "observer failed" );
+        }
+    } );
+
+    std::vector<int> results;
+    auto obs = observe( sum, [&]( int v ) { results.push_back( v ); } );
+
+    bool thrown = false;
+    std::thread urgent( [&] {
+        while( !turn_started )
+        {
+            std::this_thread::yield();
+        }
+        try
+        {
+            ctx.do_transaction( ureact::turn_priority::urgent, [&] { b <<= 10; } );
+        }
+        catch( const std::runtime_error& )
+        {
+            thrown = true;
+        }
+    } );
+
+    CHECK_THROWS_AS( a <<= 1, std::runtime_error );
+    urgent.join();
+
+    // Urgent transaction was not merged, so it fails with the exception of the turn
+    CHECK( thrown );
+    CHECK( b.value() == 0 );
+    CHECK( results.empty() );
+
+    // Nodes left queued by the turn are unmarked, so the next turns propagate them
+    b <<= 2;
+    CHECK( results == std::vector<int>{ 3 } );
+
+    // Turn depth is restored, so an urgent transaction is performed as a normal one
+    ctx.do_transaction( ureact::turn_priority::urgent, [&] { b <<= 3; } );
+    CHECK( results == std::vector<int>{ 3, 4 } );
+}
+
+TEST_CASE( "UrgentTransactionWithoutRunningTurn" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> b = a * 2;
+
+    ctx.do_transaction( ureact::turn_priority::urgent, [&] { a <<= 2; } );
+    CHECK( b.value() == 4 );
+
+    // Single-threaded context treats urgent transactions as normal ones
+    ureact::context st_ctx;
+    auto c = make_var( st_ctx, 0 );
+    st_ctx.do_transaction( ureact::turn_priority::urgent, [&] { c <<= 3; } );
+    CHECK( c.value() == 3 );
+}
+
+TEST_CASE( "CriticalObserversFirst" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+
+    std::vector<int> order;
+    auto obs1 = observe( a, [&]( int /*v*/ ) { order.push_back( 1 ); } );
+    auto obs2 = observe( a, [&]( int /*v*/ ) { order.push_back( 2 ); } );
+    auto obs3 = observe( a, [&]( int /*v*/ ) { order.push_back( 3 ); } );
+
+    set_critical( obs3 );
+
+    a <<= 1;
+
+    REQUIRE( order.size() == 3 );
+    CHECK( order[0] == 3 );
+}
+
+TEST_CASE( "CriticalObserverBeforeLowerLevelObservers" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    ureact::signal<int> b = a + 1;
+    ureact::signal<int> c = b + 1;
+
+    std::vector<int> order;
+    auto obs1 = observe( a, [&]( int /*v*/ ) { order.push_back( 1 ); } );
+    auto obs2 = observe( c, [&]( int /*v*/ ) { order.push_back( 2 ); } );
+
+    {
+        auto obs3 = observe( c, [&]( int /*v*/ ) { order.push_back( 3 ); } );
+        set_critical( obs3 );
+
+        a <<= 1;
+        CHECK( order == std::vector<int>{ 3, 1, 2 } );
+
+        obs3.detach();
+    }
+
+    // Without critical observers the others aren't deferred anymore
+    order.clear();
+    a <<= 2;
+    CHECK( order == std::vector<int>{ 1, 2 } );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,107 @@
+#include <map>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+
+namespace
+{
+
+// Keeps pending nodes in buckets sorted by level
+class bucket_scheduler final : public ureact::scheduler
+{
+public:
+    explicit bucket_scheduler( int& pushes )
+        : m_pushes( pushes )
+    {}
+
+    void push( const value_type node, const int level ) override
+    {
+        ++m_pushes;
+        m_buckets[level].push_back( node );
+    }
+
+    bool fetch_next() override
+    {
+        m_next.clear();
+        if( m_buckets.empty() )
+        {
+            return false;
+        }
+        const auto it = m_buckets.begin();
+        m_level = it->first;
+        m_next.swap( it->second );
+        m_buckets.erase( it );
+        return true;
+    }
+
+    const std::vector<value_type>& next_values() const override
+    {
+        return m_next;
+    }
+
+    int next_level() const override
+    {
+        return m_level;
+    }
+
+private:
+    int& m_pushes;
+    std::map<int, std::vector<value_type>> m_buckets;
+    std::vector<value_type> m_next;
+    int m_level = 0;
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN( "SchedulerTest" );
+
+TEST_CASE( "CustomScheduler" )
+{
+    int pushes = 0;
+    ureact::context ctx( std::unique_ptr<ureact::scheduler>(
+        new bucket_scheduler( pushes ) ) );
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> left = a + 1;
+    ureact::signal<int> right = a * 2;
+    ureact::signal<int> diamond = left + right;
+
+    std::vector<int> results;
+    auto obs = observe( diamond, [&]( int v ) { results.push_back( v ); } );
+
+    a <<= 2;
+    a <<= 3;
+
+    // Observer is called once per turn with consistent values
+    CHECK( results == std::vector<int>{ 7, 10 } );
+    CHECK( pushes > 0 );
+}
+
+TEST_CASE( "CustomSchedulerLevelChanges" )
+{
+    int pushes = 0;
+    ureact::context ctx( std::unique_ptr<ureact::scheduler>(
+        new bucket_scheduler( pushes ) ) );
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> shallow = +a;
+    ureact::signal<int> deep = make_signal( make_signal( a, []( int v ) { return v + 1; } ),
+        []( int v ) { return v * 10; } );
+
+    auto outer = make_var( ctx, shallow );
+    ureact::signal<int> flat = flatten( outer );
+    ureact::signal<int> result = flat + a;
+
+    std::vector<int> results;
+    auto obs = observe( result, [&]( int v ) { results.push_back( v ); } );
+
+    // flatten node and its successors are moved to higher levels during the turn
+    outer <<= deep;
+    a <<= 2;
+
+    CHECK( results == std::vector<int>{ 21, 32 } );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,78 @@
+#include <vector>
+
+#include <doctest.h>
+
+#include "tick_counter.hpp"
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "SelectTest" );
+
+TEST_CASE( "IfThenElse" )
+{
+    ureact::context ctx;
+
+    auto cond = make_var( ctx, true );
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 2 );
+
+    ureact::signal<int> result = if_then_else( cond, a, b );
+
+    std::vector<int> values;
+    auto obs = observe( result, [&]( int v ) { values.push_back( v ); } );
+
+    CHECK( result.value() == 1 );
+
+    tick_counter counter( ctx );
+
+    // Inactive branch isn't tracked
+    b <<= 20;
+    CHECK( counter.ticks == 0 );
+
+    a <<= 10;
+    CHECK( result.value() == 10 );
+
+    cond <<= false;
+    CHECK( result.value() == 20 );
+
+    counter.ticks = 0;
+    a <<= 100;
+    CHECK( counter.ticks == 0 );
+
+    b <<= 200;
+    CHECK( result.value() == 200 );
+
+    CHECK( values == std::vector<int>{ 10, 20, 200 } );
+}
+
+TEST_CASE( "Select" )
+{
+    ureact::context ctx;
+
+    auto index = make_var( ctx, 0 );
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 2 );
+    ureact::signal<int> c = b * 10;
+
+    ureact::signal<int> result = select( index, a, b, c );
+    ureact::signal<int> plus_one = result + 1;
+
+    CHECK( plus_one.value() == 2 );
+
+    index <<= 2;
+    CHECK( result.value() == 20 );
+    CHECK( plus_one.value() == 21 );
+
+    // Selected branch is deeper than the previous one
+    b <<= 3;
+    CHECK( result.value() == 30 );
+    CHECK( plus_one.value() == 31 );
+
+    ctx.do_transaction( [&] {
+        index <<= 1;
+        b <<= 4;
+    } );
+    CHECK( result.value() == 4 );
+    CHECK( plus_one.value() == 5 );
+}
+
+TEST_SUITE_END();
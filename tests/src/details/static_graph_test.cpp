@@ -0,0 +1,143 @@
+#include <doctest.h>
+
+#include <vector>
+
+#include "ureact/static_graph.hpp"
+
+namespace
+{
+
+struct price
+{};
+struct quantity
+{};
+struct discount
+{};
+struct total
+{};
+struct discounted
+{};
+struct total_log
+{};
+struct discount_log
+{};
+struct total_out
+{};
+
+struct multiply
+{
+    int operator()( int p, int q ) const
+    {
+        return p * q;
+    }
+};
+
+struct apply_discount
+{
+    int operator()( int t, int d ) const
+    {
+        return t - t * d / 100;
+    }
+};
+
+struct logger
+{
+    std::vector<int>* log = nullptr;
+
+    void operator()( int v ) const
+    {
+        log->push_back( v );
+    }
+};
+
+using graph_t = ureact::static_graph<ureact::static_input<price, int>,
+    ureact::static_input<quantity, int>,
+    ureact::static_input<discount, int>,
+    ureact::static_signal<total, multiply, price, quantity>,
+    ureact::static_signal<discounted, apply_discount, total, discount>,
+    ureact::static_observer<total_log, logger, total>,
+    ureact::static_observer<discount_log, logger, discounted>,
+    ureact::static_output<total_out, discounted>>;
+
+} // namespace
+
+TEST_SUITE_BEGIN( "StaticGraphTest" );
+
+TEST_CASE( "Update" )
+{
+    static_assert( std::is_same<graph_t::value_t<total>, int>::value, "" );
+
+    graph_t graph;
+
+    std::vector<int> totals;
+    std::vector<int> discounts;
+    graph.function<total_log>().log = &totals;
+    graph.function<discount_log>().log = &discounts;
+
+    CHECK( graph.get<total>() == 0 );
+
+    graph.set<price>( 10 );
+    CHECK( graph.get<total>() == 0 ); // quantity is still 0
+    CHECK( totals.empty() );
+
+    graph.set<quantity>( 3 );
+    CHECK( graph.get<total>() == 30 );
+    CHECK( graph.get<discounted>() == 30 );
+    CHECK( totals == std::vector<int>{ 30 } );
+    CHECK( discounts == std::vector<int>{ 30 } );
+
+    graph.set<discount>( 10 );
+    CHECK( graph.get<discounted>() == 27 );
+    CHECK( totals == std::vector<int>{ 30 } ); // total doesn't depend on discount
+    CHECK( discounts == std::vector<int>{ 30, 27 } );
+
+    // Same value doesn't trigger updates
+    graph.set<price>( 10 );
+    CHECK( totals.size() == 1 );
+
+    // Changed total with unchanged discounted value
+    graph.set<discount>( 100 );
+    discounts.clear();
+    graph.set<price>( 20 );
+    CHECK( totals == std::vector<int>{ 30, 60 } );
+    CHECK( discounts.empty() );
+}
+
+TEST_CASE( "ContextBoundaries" )
+{
+    ureact::context ctx;
+
+    auto src_price = make_var( ctx, 5 );
+    auto src_quantity = make_var( ctx, 2 );
+
+    ureact::context out_ctx;
+    auto result = make_var( out_ctx, -1 );
+
+    graph_t graph;
+    std::vector<int> log;
+    graph.function<total_log>().log = &log;
+    graph.function<discount_log>().log = &log;
+
+    graph.connect<total_out>( result );
+    CHECK( result.value() == 0 );
+
+    auto quantity_binding = ureact::bind_input<quantity>( graph, src_quantity );
+    {
+        auto price_binding = ureact::bind_input<price>( graph, src_price );
+        CHECK( graph.get<total>() == 10 );
+        CHECK( result.value() == 10 );
+
+        src_price <<= 7;
+        CHECK( graph.get<total>() == 14 );
+        CHECK( result.value() == 14 );
+    }
+
+    // Binding is removed together with the scoped observer
+    src_price <<= 8;
+    CHECK( result.value() == 14 );
+
+    src_quantity <<= 3;
+    CHECK( result.value() == 21 );
+}
+
+TEST_SUITE_END();
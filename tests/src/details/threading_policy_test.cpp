@@ -0,0 +1,67 @@
+#include <thread>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "ThreadingPolicyTest" );
+
+TEST_CASE( "DefaultPolicy" )
+{
+    ureact::context ctx;
+    CHECK( ctx.get_threading_policy() == ureact::threading_policy::single_threaded );
+
+    ureact::context thread_safe_ctx( ureact::threading_policy::thread_safe_inputs );
+    CHECK( thread_safe_ctx.get_threading_policy()
+           == ureact::threading_policy::thread_safe_inputs );
+}
+
+TEST_CASE( "ThreadSafeInputs" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    auto counter = make_var( ctx, 0 );
+    auto other = make_var( ctx, 0 );
+    ureact::signal<int> sum = counter + other;
+
+    int observed = 0;
+    int last = 0;
+    auto obs = observe( sum, [&]( int v ) {
+        ++observed;
+        last = v;
+    } );
+
+    const int iterations = 1000;
+
+    auto increment = [&]() {
+        for( int i = 0; i < iterations; ++i )
+        {
+            counter.modify( []( int& v ) { ++v; } );
+        }
+    };
+
+    auto transactions = [&]() {
+        for( int i = 0; i < iterations; ++i )
+        {
+            ctx.do_transaction( [&] {
+                counter.modify( []( int& v ) { ++v; } );
+                other.modify( []( int& v ) { ++v; } );
+            } );
+        }
+    };
+
+    std::thread t1( increment );
+    std::thread t2( increment );
+    std::thread t3( transactions );
+    t1.join();
+    t2.join();
+    t3.join();
+
+    CHECK( counter.value() == 3 * iterations );
+    CHECK( other.value() == iterations );
+    CHECK( last == 4 * iterations );
+    CHECK( observed == 3 * iterations );
+}
+
+TEST_SUITE_END();
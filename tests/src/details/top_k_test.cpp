@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <vector>
+
+#include <doctest.h>
+
+#include "ureact/top_k.hpp"
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "TopKTest" );
+
+TEST_CASE( "TopK" )
+{
+    ureact::context ctx;
+
+    std::vector<ureact::var_signal<int>> inputs;
+    std::vector<ureact::signal<int>> signals;
+    for( int i = 0; i < 1000; ++i )
+    {
+        inputs.push_back( make_var( ctx, i % 100 ) );
+        signals.push_back( inputs.back() );
+    }
+
+    int key_calls = 0;
+    ureact::signal<std::vector<size_t>> top = top_k( signals, 3, [&]( int v ) {
+        ++key_calls;
+        return v;
+    } );
+
+    int changes = 0;
+    auto obs = observe( top, [&]( const std::vector<size_t>& /*v*/ ) { ++changes; } );
+
+    // Equal keys are ordered by index
+    CHECK( top.value() == std::vector<size_t>{ 99, 199, 299 } );
+
+    key_calls = 0;
+
+    // Change outside of the top doesn't propagate
+    inputs[5] <<= 50;
+    CHECK( changes == 0 );
+    CHECK( key_calls == 1 );
+
+    inputs[5] <<= 1000;
+    CHECK( top.value() == std::vector<size_t>{ 5, 99, 199 } );
+
+    ctx.do_transaction( [&] {
+        inputs[5] <<= 0;
+        inputs[7] <<= 500;
+        inputs[8] <<= 600;
+    } );
+    CHECK( top.value() == std::vector<size_t>{ 8, 7, 99 } );
+    CHECK( key_calls == 5 );
+
+    // Order change inside of the top
+    inputs[7] <<= 700;
+    CHECK( top.value() == std::vector<size_t>{ 7, 8, 99 } );
+
+    CHECK( changes == 3 );
+}
+
+TEST_CASE( "SortedView" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 3 );
+    auto b = make_var( ctx, 1 );
+    auto c = make_var( ctx, 2 );
+    ureact::signal<int> d = a + b;
+
+    // Ascending order by negated key
+    ureact::signal<std::vector<size_t>> sorted
+        = top_k( std::vector<ureact::signal<int>>{ a, b, c, d }, 4, []( int v ) { return -v; } );
+
+    CHECK( sorted.value() == std::vector<size_t>{ 1, 2, 0, 3 } );
+
+    b <<= 10;
+    CHECK( sorted.value() == std::vector<size_t>{ 2, 0, 1, 3 } );
+}
+
+TEST_CASE( "MatchesFullSort" )
+{
+    ureact::context ctx;
+
+    const size_t count = 50;
+    const size_t k = 5;
+
+    std::vector<ureact::var_signal<int>> inputs;
+    std::vector<ureact::signal<int>> signals;
+    std::vector<int> values;
+    for( size_t i = 0; i < count; ++i )
+    {
+        inputs.push_back( make_var( ctx, 0 ) );
+        signals.push_back( inputs.back() );
+        values.push_back( 0 );
+    }
+
+    ureact::signal<std::vector<size_t>> top = top_k( signals, k, []( int v ) { return v; } );
+
+    // Changes inside, outside and across the boundary of the top
+    unsigned seed = 1;
+    for( int step = 0; step < 500; ++step )
+    {
+        seed = seed * 1103515245u + 12345u;
+        const size_t i = ( seed >> 8 ) % count;
+        seed = seed * 1103515245u + 12345u;
+        const int v = static_cast<int>( ( seed >> 8 ) % 20 );
+
+        inputs[i] <<= v;
+        values[i] = v;
+
+        std::vector<size_t> expected( count );
+        for( size_t j = 0; j < count; ++j )
+        {
+            expected[j] = j;
+        }
+        std::stable_sort( expected.begin(), expected.end(), [&]( size_t lhs, size_t rhs ) {
+            return values[lhs] > values[rhs];
+        } );
+        expected.resize( k );
+
+        REQUIRE( top.value() == expected );
+    }
+}
+
+TEST_SUITE_END();
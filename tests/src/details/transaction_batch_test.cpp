@@ -0,0 +1,205 @@
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <doctest.h>
+
+#include "tick_counter.hpp"
+#include "ureact/ureact.hpp"
+
+TEST_SUITE_BEGIN( "TransactionBatchTest" );
+
+TEST_CASE( "IndependentTransactionsShareTurn" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+    ureact::signal<int> a2 = a * 2;
+    ureact::signal<int> b2 = b * 2;
+
+    std::vector<int> a_values;
+    std::vector<int> b_values;
+    auto obs_a = observe( a2, [&]( int v ) { a_values.push_back( v ); } );
+    auto obs_b = observe( b2, [&]( int v ) { b_values.push_back( v ); } );
+
+    tick_counter counter( ctx );
+
+    std::vector<std::function<void()>> transactions{
+        [&] { a <<= 1; },
+        [&] { b <<= 2; },
+    };
+    ctx.do_transactions( transactions );
+
+    CHECK( counter.turns == 1 );
+    CHECK( a_values == std::vector<int>{ 2 } );
+    CHECK( b_values == std::vector<int>{ 4 } );
+}
+
+TEST_CASE( "ConflictingTransactionsAreSerial" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+    auto c = make_var( ctx, 0 );
+    ureact::signal<int> sum = a + b;
+
+    std::vector<int> a_values;
+    std::vector<int> sum_values;
+    auto obs_a = observe( a, [&]( int v ) { a_values.push_back( v ); } );
+    auto obs_sum = observe( sum, [&]( int v ) { sum_values.push_back( v ); } );
+
+    tick_counter counter( ctx );
+
+    std::vector<std::function<void()>> transactions{
+        [&] { a <<= 1; },
+        [&] { c <<= 1; },
+        [&] { a.modify( []( int& v ) { v += 10; } ); },
+        [&] { b <<= 100; },
+    };
+    ctx.do_transactions( transactions );
+
+    // Same values as if transactions were performed one by one
+    CHECK( a_values == std::vector<int>{ 1, 11 } );
+    CHECK( sum_values == std::vector<int>{ 1, 11, 111 } );
+    CHECK( c.value() == 1 );
+
+    // Setting of c is merged into the first turn
+    CHECK( counter.turns == 3 );
+}
+
+TEST_CASE( "ObserverChangesInputBetweenGroups" )
+{
+    const auto run = []( const bool batch ) {
+        ureact::context ctx;
+
+        auto a = make_var( ctx, 0 );
+        auto b = make_var( ctx, 0 );
+        ureact::signal<int> sum = a + b;
+
+        auto obs_a = observe( a, [&]( int /*v*/ ) { b <<= 100; } );
+
+        std::vector<int> sum_values;
+        auto obs_sum = observe( sum, [&]( int v ) { sum_values.push_back( v ); } );
+
+        std::vector<std::function<void()>> transactions{
+            [&] { a <<= 1; },
+            [&] { a <<= 2; },
+        };
+        if( batch )
+        {
+            ctx.do_transactions( transactions );
+        }
+        else
+        {
+            for( const auto& func : transactions )
+            {
+                ctx.do_transaction( func );
+            }
+        }
+        return sum_values;
+    };
+
+    // Change made by the observer isn't merged into the next transaction
+    CHECK( run( true ) == run( false ) );
+    CHECK( run( true ).back() == 102 );
+}
+
+TEST_CASE( "ObserverRunsBatchBetweenGroups" )
+{
+    const auto run = []( const bool batch ) {
+        ureact::context ctx;
+
+        auto a = make_var( ctx, 0 );
+        auto c = make_var( ctx, 0 );
+        ureact::signal<int> sum = a + c;
+
+        auto obs_a = observe( a, [&]( int v ) {
+            ctx.do_transactions( std::vector<std::function<void()>>{ [&, v] { c <<= v * 10; } } );
+        } );
+
+        std::vector<int> sum_values;
+        auto obs_sum = observe( sum, [&]( int v ) { sum_values.push_back( v ); } );
+
+        std::vector<std::function<void()>> transactions{
+            [&] { a <<= 1; },
+            [&] { a <<= 2; },
+            [&] { c <<= 5; },
+        };
+        if( batch )
+        {
+            ctx.do_transactions( transactions );
+        }
+        else
+        {
+            for( const auto& func : transactions )
+            {
+                ctx.do_transaction( func );
+            }
+        }
+        return sum_values;
+    };
+
+    // Reach marked by the nested batch doesn't hide conflicts of the outer one
+    CHECK( run( true ) == run( false ) );
+    CHECK( run( true ).back() == 7 );
+}
+
+TEST_CASE( "NestedIntoTransaction" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+
+    int observed = 0;
+    auto obs = observe( a, [&]( int /*v*/ ) { ++observed; } );
+
+    std::vector<std::function<void()>> transactions{
+        [&] { a <<= 1; },
+        [&] { a <<= 2; },
+    };
+    ctx.do_transaction( [&] { ctx.do_transactions( transactions ); } );
+
+    CHECK( a.value() == 2 );
+    CHECK( observed == 1 );
+}
+
+TEST_CASE( "ThrowingTransaction" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 0 );
+    auto b = make_var( ctx, 0 );
+    auto c = make_var( ctx, 0 );
+    ureact::signal<int> sum = a + b + c;
+
+    // Inputs changed before the throw are applied as in a serial loop,
+    // the next transactions are not performed
+    std::vector<std::function<void()>> transactions{
+        [&] { a <<= 1; },
+        [&] {
+            b <<= 2;
+            throw std::runtime_error( "failed" );
+        },
+        [&] { c <<= 3; },
+    };
+    CHECK_THROWS_AS( ctx.do_transactions( transactions ), std::runtime_error );
+    CHECK( sum.value() == 3 );
+    CHECK( c.value() == 0 );
+
+    CHECK_THROWS_AS( ctx.do_transaction( [&] {
+        c <<= 4;
+        throw std::runtime_error( "failed" );
+    } ),
+        std::runtime_error );
+    CHECK( sum.value() == 7 );
+
+    // Transaction level and batch are restored
+    a <<= 5;
+    CHECK( sum.value() == 11 );
+    ctx.do_transactions( std::vector<std::function<void()>>{ [&] { b <<= 6; } } );
+    CHECK( sum.value() == 15 );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,158 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <doctest.h>
+
+#include "ureact/flight_recorder.hpp"
+#include "ureact/parallel_executor.hpp"
+#include "ureact/turn_metrics.hpp"
+
+TEST_SUITE_BEGIN( "TurnMetricsTest" );
+
+TEST_CASE( "HdrHistogramBuckets" )
+{
+    for( std::uint64_t value : { 0ull, 1ull, 63ull, 64ull, 65ull, 1000ull, 123456789ull, ~0ull } )
+    {
+        const int index = ureact::hdr_histogram::bucket_index( value );
+        CHECK( index < ureact::hdr_histogram::bucket_count );
+
+        const std::uint64_t upper = ureact::hdr_histogram::bucket_upper_bound( index );
+        CHECK( upper >= value );
+        CHECK( upper - value <= value / 32 );
+    }
+
+    ureact::hdr_histogram histogram;
+    for( std::uint64_t i = 1; i <= 100; ++i )
+    {
+        histogram.record( i );
+    }
+
+    CHECK( histogram.count() == 100 );
+    CHECK( histogram.sum() == 5050 );
+    CHECK( histogram.max() == 100 );
+    CHECK( histogram.count_at_or_below( 10 ) == 10 );
+    CHECK( histogram.value_at_quantile( 0.5 ) == 50 );
+    CHECK( histogram.value_at_quantile( 0.99 ) >= 99 );
+    CHECK( histogram.value_at_quantile( 1.0 ) == 100 );
+
+    // Quantile rank is rounded up
+    CHECK( histogram.value_at_quantile( 0.505 ) == 51 );
+}
+
+TEST_CASE( "HdrHistogramCountAtOrBelow" )
+{
+    ureact::hdr_histogram histogram;
+    histogram.record( 1000 );
+    histogram.record( 1010 );
+
+    // 1000 lies in the 992-1007 sub-bucket, which is not counted partially
+    CHECK( histogram.count_at_or_below( 999 ) == 0 );
+    CHECK( histogram.count_at_or_below( 1000 ) == 0 );
+    CHECK( histogram.count_at_or_below( 1023 ) == 2 );
+
+    const int index = ureact::hdr_histogram::bucket_index( 1000 );
+    CHECK( histogram.count_at_or_below( ureact::hdr_histogram::bucket_upper_bound( index ) )
+           == 1 );
+}
+
+TEST_CASE( "CollectTurnMetrics" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    auto b = make_var( ctx, 1 );
+
+    ureact::signal<int> sum = a + b;
+    ureact::signal<int> product = a * b;
+
+    int observed = 0;
+    observe( sum, [&]( int /*v*/ ) { ++observed; } );
+
+    ureact::turn_metrics metrics( ctx );
+
+    a <<= 2;
+    b <<= 5;
+    b <<= 5;
+
+    CHECK( observed == 2 );
+
+    CHECK( metrics.turn_duration().count() == 3 );
+    CHECK( metrics.ticked_nodes().count() == 3 );
+    CHECK( metrics.ticked_nodes().max() == 3 );
+    CHECK( metrics.ticked_nodes().count_at_or_below( 0 ) == 1 );
+    CHECK( metrics.observer_latency().count() == 2 );
+
+    const std::string text = metrics.to_prometheus();
+    CHECK( text.find( "# TYPE ureact_turn_duration_nanoseconds histogram\n" )
+           != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_bucket{le=\"1\"} 1\n" ) != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_bucket{le=\"2\"} 1\n" ) != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_bucket{le=\"5\"} 3\n" ) != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_bucket{le=\"1000000\"} 3\n" )
+           != std::string::npos );
+    CHECK( text.find( "ureact_turn_duration_nanoseconds_bucket{le=\"10000000000\"}" )
+           != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_bucket{le=\"+Inf\"} 3\n" ) != std::string::npos );
+    CHECK( text.find( "ureact_turn_ticked_nodes_sum 6\n" ) != std::string::npos );
+    CHECK( text.find( "ureact_observer_latency_nanoseconds_count 2\n" ) != std::string::npos );
+
+    metrics.reset();
+    CHECK( metrics.turn_duration().count() == 0 );
+}
+
+TEST_CASE( "ObserverLatencyFromInputAdmission" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> doubled = a * 2;
+    ureact::observer obs = observe( doubled, []( int /*v*/ ) {} );
+
+    ureact::turn_metrics metrics( ctx );
+
+    // Input is admitted before the rest of the transaction is run
+    const auto delay = std::chrono::milliseconds( 2 );
+    ctx.do_transaction( [&] {
+        a <<= 2;
+        std::this_thread::sleep_for( delay );
+    } );
+
+    REQUIRE( metrics.observer_latency().count() == 1 );
+    CHECK( metrics.observer_latency().max()
+           >= static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>( delay ).count() ) );
+}
+
+TEST_CASE( "MetricsKeepFastPathsEnabled" )
+{
+    ureact::context ctx( ureact::threading_policy::thread_safe_inputs );
+
+    ureact::parallel_observer_phase_options options;
+    options.workers = 2;
+    ureact::parallel_observer_phase phase( ctx, options );
+
+    // Several recorders can be attached at the same time
+    ureact::flight_recorder recorder( ctx, 4 );
+    ureact::turn_metrics metrics( ctx );
+
+    auto src = make_var( ctx, 0 );
+    ureact::signal<int> a = src + 1;
+    ureact::signal<int> b = src + 2;
+
+    std::atomic<int> sum{ 0 };
+    ureact::observer obs_a = observe( a, [&]( int v ) { sum += v; } );
+    ureact::observer obs_b = observe( b, [&]( int v ) { sum += v; } );
+
+    src <<= 1;
+
+    CHECK( sum == 5 );
+    CHECK( phase.parallel_phases() == 1 );
+    CHECK( recorder.count() == 1 );
+    CHECK( metrics.turn_duration().count() == 1 );
+    CHECK( metrics.ticked_nodes().max() == 4 );
+    CHECK( metrics.observer_latency().count() == 2 );
+}
+
+TEST_SUITE_END();
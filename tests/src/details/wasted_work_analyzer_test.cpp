@@ -0,0 +1,172 @@
+#include <string>
+
+#include <doctest.h>
+
+#include "ureact/wasted_work_analyzer.hpp"
+
+TEST_SUITE_BEGIN( "WastedWorkAnalyzerTest" );
+
+TEST_CASE( "DetectWastedWork" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+    ureact::signal<int> doubled = src * 2;
+    ureact::signal<int> hundreds = doubled / 100;
+
+    set_debug_name( src, "src" );
+    set_debug_name( doubled, "doubled" );
+    set_debug_name( hundreds, "hundreds" );
+
+    int observed = 0;
+    observe( hundreds, [&]( int /*v*/ ) { ++observed; } );
+
+    ureact::wasted_work_analyzer analyzer( ctx );
+
+    for( int i = 2; i <= 10; ++i )
+    {
+        src <<= i;
+    }
+    src <<= 100;
+
+    CHECK( observed == 1 );
+
+    const auto report = analyzer.report();
+    REQUIRE( report.size() == 3 );
+
+    const auto find = [&]( const char* name ) -> const ureact::wasted_work_entry& {
+        for( const auto& entry : report )
+            if( entry.name == name )
+                return entry;
+        FAIL( "entry is not found" );
+        return report.front();
+    };
+
+    const auto& src_entry = find( "src" );
+    CHECK( src_entry.node == node_id( src ) );
+    CHECK( src_entry.ticks == 0 );
+    CHECK( src_entry.changes == 10 );
+    CHECK( src_entry.fruitless_changes == 9 );
+    CHECK( src_entry.suggestion == ureact::wasted_work_suggestion::upstream_filter );
+
+    const auto& doubled_entry = find( "doubled" );
+    CHECK( doubled_entry.ticks == 10 );
+    CHECK( doubled_entry.unchanged_ticks == 0 );
+    CHECK( doubled_entry.changes == 10 );
+    CHECK( doubled_entry.absorbed_changes == 9 );
+    CHECK( doubled_entry.suggestion == ureact::wasted_work_suggestion::tolerance_comparator );
+
+    const auto& hundreds_entry = find( "hundreds" );
+    CHECK( hundreds_entry.ticks == 10 );
+    CHECK( hundreds_entry.unchanged_ticks == 9 );
+    CHECK( hundreds_entry.changes == 1 );
+    CHECK( hundreds_entry.suggestion == ureact::wasted_work_suggestion::memoize );
+
+    const std::string text = analyzer.report_text();
+    CHECK( text.find( "hundreds 10 9 " ) != std::string::npos );
+    CHECK( text.find( " memoize\n" ) != std::string::npos );
+
+    analyzer.reset();
+    CHECK( analyzer.report().empty() );
+}
+
+TEST_CASE( "NoWasteNoReport" )
+{
+    ureact::context ctx;
+
+    auto a = make_var( ctx, 1 );
+    ureact::signal<int> b = a + 1;
+
+    observe( b, []( int /*v*/ ) {} );
+
+    ureact::wasted_work_analyzer analyzer( ctx );
+
+    a <<= 2;
+    a <<= 3;
+
+    CHECK( analyzer.report().empty() );
+}
+
+TEST_CASE( "NodeIdsAreNotReused" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+
+    ureact::wasted_work_analyzer analyzer( ctx );
+
+    ureact::detail::node_id_t old_id;
+    {
+        ureact::signal<int> wasteful = src / 100;
+        old_id = node_id( wasteful );
+        src <<= 2;
+        src <<= 3;
+    }
+
+    // New node can take the address of the destroyed one, but it doesn't inherit its stats
+    ureact::signal<int> fresh = src / 100;
+    CHECK( node_id( fresh ) != old_id );
+
+    src <<= 4;
+
+    bool found = false;
+    for( const auto& entry : analyzer.report() )
+    {
+        if( entry.node == node_id( fresh ) )
+        {
+            found = true;
+            CHECK( entry.ticks == 1 );
+        }
+    }
+    CHECK( found );
+}
+
+TEST_CASE( "NodeChangedTwiceInTurn" )
+{
+    ureact::context ctx;
+
+    auto trigger = make_var( ctx, 0 );
+    auto src = make_var( ctx, 1 );
+    ureact::signal<int> coarse = src / 100;
+
+    // Both inputs are set by nested turns, so src changes twice in the trigger's turn
+    ureact::observer obs = observe( trigger, [&]( int /*v*/ ) {
+        src <<= 2;
+        src <<= 3;
+    } );
+
+    ureact::wasted_work_analyzer analyzer( ctx );
+
+    trigger <<= 1;
+
+    bool found = false;
+    for( const auto& entry : analyzer.report() )
+    {
+        if( entry.node == node_id( src ) )
+        {
+            found = true;
+            CHECK( entry.changes == 2 );
+            CHECK( entry.absorbed_changes == 1 );
+        }
+    }
+    CHECK( found );
+}
+
+TEST_CASE( "ChangedNodeDestroyedDuringTurn" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+    ureact::signal<int> doubled = src * 2;
+
+    ureact::wasted_work_analyzer analyzer( ctx );
+
+    // Changed node is destroyed before the turn end processing
+    ureact::observer obs = observe( src, [&]( int /*v*/ ) { doubled = ureact::signal<int>(); } );
+
+    src <<= 2;
+
+    CHECK( !doubled.is_valid() );
+}
+
+TEST_SUITE_END();
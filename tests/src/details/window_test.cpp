@@ -0,0 +1,196 @@
+#include <chrono>
+
+#include <doctest.h>
+
+#include "ureact/ureact.hpp"
+#include "ureact/window.hpp"
+
+namespace
+{
+
+class manual_clock
+{
+public:
+    using duration = std::chrono::milliseconds;
+    using time_point = std::chrono::time_point<manual_clock, duration>;
+
+    explicit manual_clock( const duration& now )
+        : m_now( &now )
+    {}
+
+    time_point now() const
+    {
+        return time_point( *m_now );
+    }
+
+private:
+    const duration* m_now;
+};
+
+} // namespace
+
+TEST_SUITE_BEGIN( "WindowTest" );
+
+TEST_CASE( "CountWindow" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+
+    ureact::signal<int> sum = window_sum( src, ureact::count_window( 3 ) );
+    ureact::signal<double> mean = window_mean( src, ureact::count_window( 3 ) );
+    ureact::signal<int> min = window_min( src, ureact::count_window( 3 ) );
+    ureact::signal<int> max = window_max( src, ureact::count_window( 3 ) );
+
+    CHECK( sum.value() == 1 );
+    CHECK( max.value() == 1 );
+
+    src <<= 5;
+    src <<= 3;
+    CHECK( sum.value() == 9 );
+    CHECK( mean.value() == doctest::Approx( 3.0 ) );
+    CHECK( min.value() == 1 );
+    CHECK( max.value() == 5 );
+
+    // 1 is evicted
+    src <<= 2;
+    CHECK( sum.value() == 10 );
+    CHECK( min.value() == 2 );
+    CHECK( max.value() == 5 );
+
+    // 5 is evicted
+    src <<= 4;
+    src <<= 1;
+    CHECK( sum.value() == 7 );
+    CHECK( min.value() == 1 );
+    CHECK( max.value() == 4 );
+
+    // Many samples to wrap the ring buffers
+    for( int i = 0; i < 100; ++i )
+    {
+        src <<= i;
+    }
+    CHECK( sum.value() == 97 + 98 + 99 );
+    CHECK( min.value() == 97 );
+    CHECK( max.value() == 99 );
+}
+
+TEST_CASE( "TimeWindow" )
+{
+    ureact::context ctx;
+
+    std::chrono::milliseconds now( 0 );
+    const ureact::time_window<manual_clock> window(
+        std::chrono::milliseconds( 1000 ), manual_clock( now ) );
+
+    auto src = make_var( ctx, 10.0 );
+
+    ureact::signal<double> mean = window_mean( src, window );
+    ureact::signal<double> max = window_max( src, window );
+    ureact::signal<double> rate = window_rate( src, window );
+
+    now = std::chrono::milliseconds( 200 );
+    src <<= 20.0;
+    now = std::chrono::milliseconds( 400 );
+    src <<= 30.0;
+
+    CHECK( mean.value() == doctest::Approx( 20.0 ) );
+    CHECK( max.value() == doctest::Approx( 30.0 ) );
+    CHECK( rate.value() == doctest::Approx( 3.0 ) );
+
+    // Samples at 0 and 200 ms are out of the window
+    now = std::chrono::milliseconds( 1200 );
+    src <<= 5.0;
+
+    CHECK( mean.value() == doctest::Approx( 17.5 ) );
+    CHECK( max.value() == doctest::Approx( 30.0 ) );
+    CHECK( rate.value() == doctest::Approx( 2.0 ) );
+
+    // The newest sample is always in the window
+    now = std::chrono::milliseconds( 10000 );
+    src <<= 1.0;
+
+    CHECK( mean.value() == doctest::Approx( 1.0 ) );
+    CHECK( max.value() == doctest::Approx( 1.0 ) );
+}
+
+TEST_CASE( "EqualSamples" )
+{
+    ureact::context ctx;
+
+    std::chrono::milliseconds now( 0 );
+    const ureact::time_window<manual_clock> window(
+        std::chrono::milliseconds( 1000 ), manual_clock( now ) );
+
+    auto src = make_var( ctx, 1 );
+
+    ureact::signal<int> sum = window_sum( src, ureact::count_window( 3 ) );
+    ureact::signal<double> rate = window_rate( src, window );
+
+    // Setting of an equal value is a sample too
+    src <<= 1;
+    src <<= 1;
+    CHECK( sum.value() == 3 );
+    CHECK( rate.value() == doctest::Approx( 3.0 ) );
+
+    // So is each value set in a transaction
+    ctx.do_transaction( [&] {
+        src <<= 2;
+        src <<= 2;
+    } );
+    CHECK( sum.value() == 5 );
+
+    // Derived signals are sampled on changes
+    ureact::signal<int> doubled = src * 2;
+    ureact::signal<int> doubled_sum = window_sum( doubled, ureact::count_window( 3 ) );
+    src <<= 2;
+    CHECK( doubled_sum.value() == 4 );
+    src <<= 3;
+    CHECK( doubled_sum.value() == 10 );
+}
+
+TEST_CASE( "VarPassedAsSignal" )
+{
+    ureact::context ctx;
+
+    auto src = make_var( ctx, 1 );
+    const ureact::signal<int>& as_signal = src;
+
+    // Admissions are recorded only by the window created from the var itself
+    ureact::signal<int> admitted_sum = window_sum( src, ureact::count_window( 3 ) );
+    ureact::signal<int> changed_sum = window_sum( as_signal, ureact::count_window( 3 ) );
+
+    src <<= 1;
+    src <<= 2;
+    CHECK( admitted_sum.value() == 4 );
+    CHECK( changed_sum.value() == 3 );
+}
+
+TEST_CASE( "EvictOnTimer" )
+{
+    ureact::context ctx;
+
+    std::chrono::milliseconds now( 0 );
+    auto timer = make_var( ctx, 0 );
+    ureact::time_window<manual_clock> window(
+        std::chrono::milliseconds( 1000 ), manual_clock( now ) );
+    window.evict_on( timer );
+
+    auto src = make_var( ctx, 10 );
+
+    ureact::signal<int> sum = window_sum( src, window );
+    ureact::signal<double> rate = window_rate( src, window );
+
+    now = std::chrono::milliseconds( 500 );
+    src <<= 20;
+    CHECK( sum.value() == 30 );
+    CHECK( rate.value() == doctest::Approx( 2.0 ) );
+
+    // The first sample is evicted without new samples
+    now = std::chrono::milliseconds( 1200 );
+    timer <<= 1;
+    CHECK( sum.value() == 20 );
+    CHECK( rate.value() == doctest::Approx( 1.0 ) );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ureact/ureact.hpp"
+
+/// Counts propagation turns and ticked nodes of a context.
+/// It is a turn listener, so it disables fast paths of the graph while attached
+class tick_counter : private ureact::detail::scoped_turn_listener
+{
+public:
+    explicit tick_counter( ureact::context& ctx )
+        : scoped_turn_listener( ctx )
+    {}
+
+    std::uint64_t turns = 0;
+    std::uint64_t ticks = 0;
+
+private:
+    void on_turn_begin( ureact::detail::turn_id_t /*turn*/ ) override
+    {
+        ++turns;
+    }
+
+    void on_tick_end( const ureact::detail::reactive_node& /*node*/ ) override
+    {
+        ++ticks;
+    }
+};